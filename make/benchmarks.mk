@@ -0,0 +1,20 @@
+include make/top.mk
+
+BENCHMARKS_FOLDER := $(BUILD_FOLDER)/benchmarks
+BENCHMARKS_CFILES := $(wildcard src/benchmarks/*.c)
+BENCHMARKS_EXECS := $(patsubst src/benchmarks/%.c,$(BENCHMARKS_FOLDER)/%,$(BENCHMARKS_CFILES))
+
+$(BENCHMARKS_FOLDER)/%: src/benchmarks/%.c $(UTILS_CFILES)
+	@echo "- Building the $(notdir $@) benchmark"
+	mkdir -p $(BENCHMARKS_FOLDER)
+	gcc $< $(UTILS_CFILES) -o $@ $(FLAGS) -O2
+
+.PHONY: bench
+bench: $(BENCHMARKS_EXECS)
+	for b in $(BENCHMARKS_EXECS); do echo "=== $$b"; ./$$b || exit 1; done
+
+.PHONY: clean_benchmarks
+clean_benchmarks:
+	@echo "- Cleaning benchmarks"
+	rm -f $(BENCHMARKS_EXECS)
+	if [ -d $(BENCHMARKS_FOLDER) ]; then rmdir $(BENCHMARKS_FOLDER); fi
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../utils/string.h"
+#include "../utils/file.h"
+
+#define REPETITIONS 5
+
+typedef bool (*Copy_function)(const char *origin_path, const char *clone_path);
+typedef bool (*Round_trip_function)(const char *path, const char *data, size_t length);
+
+double now_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// The implementation of clone_text_file() before the file utilities
+bool copy_with_stdio(const char *origin_path, const char *clone_path) {
+  FILE *origin = fopen(origin_path, "r");
+  if (!origin) return false;
+  FILE *clone = fopen(clone_path, "w");
+  if (!clone) {
+    fclose(origin);
+    return false;
+  }
+
+  int c;
+  while ( (c = fgetc(origin)) != EOF ) fputc(c, clone);
+
+  fclose(clone);
+  fclose(origin);
+  return true;
+}
+
+bool copy_with_file_utils(const char *origin_path, const char *clone_path) {
+  return file_copy(origin_path, clone_path);
+}
+
+// The implementation of write_notes_to_temporal_file() and
+// load_notes_from_temporal_file() before the file utilities
+bool round_trip_with_stdio(const char *path, const char *data, size_t length) {
+  (void) length;
+
+  FILE *f = fopen(path, "w");
+  if (!f) return false;
+  if (fputs(data, f) == EOF) {
+    fclose(f);
+    return false;
+  }
+  fclose(f);
+
+  f = fopen(path, "r");
+  if (!f) return false;
+  long size = 0;
+  if (fseek(f, 0, SEEK_END) == -1 || (size = ftell(f)) == -1 || fseek(f, 0, SEEK_SET) == -1) {
+    fclose(f);
+    return false;
+  }
+  char *content = malloc(size + 1);
+  bool ok = (fread(content, size, 1, f) == 1);
+  content[size] = '\0';
+  free(content);
+  fclose(f);
+  return ok;
+}
+
+bool round_trip_with_file_utils(const char *path, const char *data, size_t length) {
+  if (!file_write_all(path, data, length, false)) return false;
+  char *content = file_read_all(path, NULL);
+  if (!content) return false;
+  free(content);
+  return true;
+}
+
+// Something that looks like a database generated by idea
+String_builder generate_database(unsigned int megabytes) {
+  String_builder sb = sb_create("-- File generated by idea. Edit this file with caution.\n");
+  unsigned int i = 0;
+  while (sb.length < megabytes * 1024 * 1024) {
+    sb_append_with_format(&sb, "\ntodo\n │name: ToDo number %u\n │hostname: benchmark\n │created: %u\n │notes_content:\n", i, i);
+    sb_append_with_format(&sb, " │ │# ToDo number %u\n │ │\n │ │tags: benchmark file\n │ │\n │ │- [ ] A task\n │ │- [x] Another task\n │EOF\n", i);
+    i++;
+  }
+  return sb;
+}
+
+double benchmark_copy(Copy_function copy, const char *origin_path, const char *clone_path) {
+  double best = -1;
+  for (int i = 0; i < REPETITIONS; i++) {
+    double start = now_ms();
+    if (!copy(origin_path, clone_path)) {
+      printf("Copy failed!\n");
+      exit(1);
+    }
+    double elapsed = now_ms() - start;
+    if (best < 0 || elapsed < best) best = elapsed;
+  }
+  return best;
+}
+
+double benchmark_round_trip(Round_trip_function round_trip, const char *path, String_builder data) {
+  double best = -1;
+  for (int i = 0; i < REPETITIONS; i++) {
+    double start = now_ms();
+    if (!round_trip(path, data.str, data.length)) {
+      printf("Round trip failed!\n");
+      exit(1);
+    }
+    double elapsed = now_ms() - start;
+    if (best < 0 || elapsed < best) best = elapsed;
+  }
+  return best;
+}
+
+int main() {
+  const unsigned int sizes[] = { 1, 8, 32 };
+  const unsigned int sizes_count = sizeof(sizes) / sizeof(sizes[0]);
+
+  String_builder tmp = sb_new();
+  if (!sb_append_from_shell_variable(&tmp, "TMPDIR")) sb_append(&tmp, "/tmp");
+  String_builder origin_path = sb_create("%s/idea_bench_origin.idea", tmp.str);
+  String_builder clone_path = sb_create("%s/idea_bench_clone.idea", tmp.str);
+  String_builder notes_path = sb_create("%s/idea_bench_notes.md", tmp.str);
+
+  printf("Best of %d runs (ms)\n\n", REPETITIONS);
+  printf("%7s | %14s | %14s | %14s | %14s\n", "Size", "clone (stdio)", "clone (file)", "notes (stdio)", "notes (file)");
+
+  for (unsigned int i = 0; i < sizes_count; i++) {
+    String_builder db = generate_database(sizes[i]);
+    if (!file_write_all(origin_path.str, db.str, db.length, false)) {
+      printf("Unable to write %s\n", origin_path.str);
+      return 1;
+    }
+
+    printf("%4u MB | %14.2f | %14.2f | %14.2f | %14.2f\n",
+           sizes[i],
+           benchmark_copy(copy_with_stdio, origin_path.str, clone_path.str),
+           benchmark_copy(copy_with_file_utils, origin_path.str, clone_path.str),
+           benchmark_round_trip(round_trip_with_stdio, notes_path.str, db),
+           benchmark_round_trip(round_trip_with_file_utils, notes_path.str, db));
+
+    sb_free(&db);
+  }
+
+  remove(origin_path.str);
+  remove(clone_path.str);
+  remove(notes_path.str);
+  sb_free(&origin_path);
+  sb_free(&clone_path);
+  sb_free(&notes_path);
+  sb_free(&tmp);
+  return 0;
+}
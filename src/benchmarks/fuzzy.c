@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../utils/fuzzy.h"
+#include "../utils/string.h"
+
+#define NAMES 100000
+#define TOP_K 20
+#define REPETITIONS 5
+
+double now_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+const char *words[] = {
+  "buy", "milk", "fix", "the", "bug", "in", "parser", "write", "report", "call",
+  "mom", "review", "PullRequest", "deploy", "server", "clean", "kitchen", "read",
+  "book", "about", "OperatingSystems", "update", "notes", "meeting", "with", "team",
+  "plan", "trip", "to", "Japan", "pay", "taxes", "2026", "learn", "rust", "refactor",
+};
+const unsigned int words_count = sizeof(words) / sizeof(*words);
+
+// Incremental patterns, like the ones of the TUI filter while typing
+const char *patterns[] = { "o", "op", "ope", "oper", "opers", "opersy", "opersys" };
+const unsigned int patterns_count = sizeof(patterns) / sizeof(*patterns);
+
+int main() {
+  srand(42);
+  char **names = malloc(NAMES * sizeof(char *));
+  for (unsigned int i = 0; i < NAMES; i++) {
+    String_builder sb = sb_new();
+    const unsigned int length = 3 + rand() % 5;
+    for (unsigned int w = 0; w < length; w++) {
+      if (w) sb_append_char(&sb, ' ');
+      sb_append(&sb, words[rand() % words_count]);
+    }
+    names[i] = sb.str;
+  }
+
+  Fuzzy_match matches[TOP_K];
+  double best_build = -1, best_fresh = -1, best_incremental = -1;
+  unsigned int found = 0;
+  for (int r = 0; r < REPETITIONS; r++) {
+    Fuzzy_index index;
+    double start = now_ms();
+    fuzzy_index_init(&index, (const char **) names, NAMES);
+    double elapsed = now_ms() - start;
+    if (best_build < 0 || elapsed < best_build) best_build = elapsed;
+
+    // Without narrowing: every pattern is scored against all the names
+    start = now_ms();
+    for (unsigned int p = 0; p < patterns_count; p++) {
+      free(index.last_pattern);
+      index.last_pattern = NULL;
+      found = fuzzy_search(&index, patterns[p], matches, TOP_K);
+    }
+    elapsed = (now_ms() - start) / patterns_count;
+    if (best_fresh < 0 || elapsed < best_fresh) best_fresh = elapsed;
+
+    start = now_ms();
+    for (unsigned int p = 0; p < patterns_count; p++) found = fuzzy_search(&index, patterns[p], matches, TOP_K);
+    elapsed = (now_ms() - start) / patterns_count;
+    if (best_incremental < 0 || elapsed < best_incremental) best_incremental = elapsed;
+
+    fuzzy_index_free(&index);
+  }
+
+  printf("Fuzzy search of %d names, top %d. Best of %d runs\n\n", NAMES, TOP_K, REPETITIONS);
+  printf("%-28s %8.2f ms\n", "Index build", best_build);
+  printf("%-28s %8.2f ms\n", "Query (full scan)", best_fresh);
+  printf("%-28s %8.2f ms\n", "Query (while typing)", best_incremental);
+  printf("\n'%s' matches %u names, the best one is '%s'\n", patterns[patterns_count-1], found, names[matches[0].index]);
+
+  for (unsigned int i = 0; i < NAMES; i++) free(names[i]);
+  free(names);
+  return 0;
+}
@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../utils/list.h"
+
+#define REPETITIONS 5
+#define ELEMENTS 200000
+#define CHURN_ROUNDS 20
+
+double now_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Builds a list, then removes and appends elements many times (the pattern of
+// the backtrace, the attributes of the notes and the transactions) and walks it
+unsigned long churn() {
+  List list = list_new();
+  for (unsigned long i = 1; i <= ELEMENTS; i++) list_append(&list, (void *)i); // NULL elements are not allowed
+
+  for (unsigned int round = 0; round < CHURN_ROUNDS; round++) {
+    for (unsigned int i = 0; i < ELEMENTS / 10; i++) {
+      void *element = list_remove(&list, 0);
+      list_append(&list, element);
+    }
+  }
+
+  unsigned long total = 0;
+  List_iterator iterator = list_iterator_create(list);
+  while (list_iterator_next(&iterator)) total += (unsigned long)list_iterator_element(iterator);
+
+  list_destroy(&list, NULL);
+  return total;
+}
+
+int main() {
+  double best = -1;
+  unsigned long total = 0;
+  for (int r = 0; r < REPETITIONS; r++) {
+    const double start = now_ms();
+    total = churn();
+    const double elapsed = now_ms() - start;
+    if (best < 0 || elapsed < best) best = elapsed;
+  }
+
+  const List_node_pool_stats stats = list_node_pool_stats();
+  printf("List churn with %d elements. Best of %d runs: %.2f ms (checksum %lu)\n\n", ELEMENTS, REPETITIONS, best, total);
+  printf("%12s | %12s | %8s | %8s | %8s\n", "Allocations", "Reused", "Slabs", "Live", "Peak");
+  printf("%12lu | %12lu | %8lu | %8ld | %8ld\n", stats.allocations, stats.reused, stats.slabs, stats.live, stats.peak);
+
+  list_node_pool_free();
+  return 0;
+}
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../utils/string.h"
+#include "../utils/tokenizer.h"
+
+#define REPETITIONS 5
+#define LINES 200000
+
+typedef unsigned long (*Tokenize_function)(Input *input, char divider);
+
+double now_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// The implementation of next_token() before the token views
+char *next_token_with_sb(Input *input, char divider) {
+  if (input->cursor > input->length) return NULL;
+
+  String_builder sb = sb_new();
+  unsigned int i = input->cursor;
+  bool escaped = false;
+  while (i <= input->length) {
+    const char c = input->input[i];
+
+    if (escaped) {
+      if (c == '\\') {
+        sb_append_char(&sb, c);
+      } else if (c == divider) {
+        sb_append_char(&sb, divider);
+      } else {
+        sb_append(&sb, (char[]){ '\\', c, '\0'});
+      }
+      escaped = false;
+    } else {
+      if (c == '\\') {
+        escaped = true;
+      } else {
+        if (c == divider) break;
+        sb_append_char(&sb, c);
+      }
+    }
+    i++;
+  }
+
+  input->cursor = i + 1;
+  return sb.str;
+}
+
+// Every function returns the sum of the token lengths, so the work can't be
+// optimized away and the results can be compared
+unsigned long tokenize_with_sb(Input *input, char divider) {
+  unsigned long total = 0;
+  char *token;
+  while (input->cursor <= input->length) {
+    if ( !(token = next_token_with_sb(input, divider)) ) continue;
+    total += strlen(token);
+    free(token);
+  }
+  return total;
+}
+
+unsigned long tokenize_with_next_token(Input *input, char divider) {
+  unsigned long total = 0;
+  char *token;
+  while (input->cursor <= input->length) {
+    if ( !(token = next_token(input, divider)) ) continue;
+    total += strlen(token);
+    free(token);
+  }
+  return total;
+}
+
+unsigned long tokenize_with_views(Input *input, char divider) {
+  unsigned long total = 0;
+  char buffer[256];
+  Token_view token;
+  while (input->cursor <= input->length) {
+    if (!next_token_view(input, divider, &token)) continue;
+    total += (token.escaped) ? token_view_unescape(token, divider, buffer, sizeof(buffer)) : token.length;
+  }
+  return total;
+}
+
+// Lines that look like the commands of a batch (or the lines of a save file)
+String_builder *generate_lines() {
+  const char *words[] = { "add", "Buy", "some", "milk", "edit", "12", "Call\\ the", "plumber", "--", "notes_content:", "C:\\\\Users", "2024-10-01" };
+  const unsigned int words_count = sizeof(words) / sizeof(words[0]);
+
+  String_builder *lines = malloc(LINES * sizeof(String_builder));
+  srand(42);
+  for (unsigned int i = 0; i < LINES; i++) {
+    lines[i] = sb_new();
+    const unsigned int words_in_line = 2 + rand() % 8;
+    for (unsigned int w = 0; w < words_in_line; w++) {
+      if (w) sb_append_char(&lines[i], ' ');
+      sb_append(&lines[i], words[rand() % words_count]);
+    }
+  }
+  return lines;
+}
+
+double benchmark(Tokenize_function tokenize, String_builder *lines, unsigned long *total) {
+  double best = -1;
+  for (int r = 0; r < REPETITIONS; r++) {
+    *total = 0;
+    double start = now_ms();
+    for (unsigned int i = 0; i < LINES; i++) {
+      Input input = { .input = lines[i].str, .length = lines[i].length, .cursor = 0 };
+      *total += tokenize(&input, ' ');
+    }
+    double elapsed = now_ms() - start;
+    if (best < 0 || elapsed < best) best = elapsed;
+  }
+  return best;
+}
+
+int main() {
+  const struct {
+    const char *name;
+    Tokenize_function function;
+  } tokenizers[] = {
+    { "String_builder (old)", tokenize_with_sb },
+    { "next_token", tokenize_with_next_token },
+    { "next_token_view", tokenize_with_views },
+  };
+  const unsigned int tokenizers_count = sizeof(tokenizers) / sizeof(tokenizers[0]);
+
+  String_builder *lines = generate_lines();
+
+  printf("Tokenizing %d lines. Best of %d runs\n\n", LINES, REPETITIONS);
+  printf("%20s | %10s | %12s\n", "Tokenizer", "Time (ms)", "Total length");
+
+  unsigned long expected = 0;
+  for (unsigned int t = 0; t < tokenizers_count; t++) {
+    unsigned long total = 0;
+    const double elapsed = benchmark(tokenizers[t].function, lines, &total);
+    printf("%20s | %10.2f | %12lu\n", tokenizers[t].name, elapsed, total);
+
+    if (t == 0) expected = total;
+    if (total != expected) {
+      printf("The tokenizers don't agree!\n");
+      return 1;
+    }
+  }
+
+  for (unsigned int i = 0; i < LINES; i++) sb_free(&lines[i]);
+  free(lines);
+  return 0;
+}
@@ -1,19 +1,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "cli.h"
 #include "../../main.h"
+#include "../../utils/backtrace.h"
 #include "../../utils/date.h"
 #include "../../todos/todo_list.h"
 #include "../../todos/notes_parser.h"
+#include "../../todos/search.h"
+#include "../../todos/stats.h"
 #include "../../templates/bash_completion/bash_completion.h"
 #include "../../templates/zsh_completion/zsh_completion.h"
+#include "../../../utils/intern.h"
 #include "../../../utils/list.h"
 #include "../../../utils/tokenizer.h"
 #include "../../../utils/string.h"
+#include "../../../utils/file.h"
 
 bool cli_disable_colors = false;
+bool cli_list_after_changes = true;
 
 void print_reminder(const Reminder rem, unsigned int indentation) {
   const Date now = date_now();
@@ -46,11 +53,6 @@ void print_reminder(const Reminder rem, unsigned int indentation) {
   printf("%s %s(from %s)%s\n", rem.name, ANSI_GRAY, rem.todo->name, ANSI_RESET);
 }
 
-bool is_task_complete_list_filter(void *task_p) {
-  Task *task = (Task*) task_p;
-  return !is_task_incomplete(*task);
-}
-
 typedef enum {
   TODO_ATTRIBUTE_NONE,
   TODO_ATTRIBUTE_TASKS,
@@ -81,7 +83,7 @@ bool print_todo(unsigned int index, Todo *todo, Todo_print_attributes attribute)
         if (!todo->notes) break;
 
         if (!build_attributes(todo)) return false;
-        bool has_incomplete_tasks = !list_any(todo->attributes.tasks, is_task_complete_list_filter);
+        bool has_incomplete_tasks = todo->attributes.task_counters.incomplete > 0;
 
         if (list_is_empty(todo->attributes.tasks) || (attribute == TODO_ATTRIBUTE_TASKS_INCOMPLETE && !has_incomplete_tasks)) break;
         printf( "%s%d)%s %s%s%s\n", ANSI_RED, index + 1, ANSI_RESET, ANSI_UNDERLINE, todo->name, ANSI_RESET);
@@ -91,20 +93,7 @@ bool print_todo(unsigned int index, Todo *todo, Todo_print_attributes attribute)
           const Task *task = list_iterator_element(iterator);
 
           // To ensure that the parent Task is shown if at least one of the children are incomplete
-          if (attribute == TODO_ATTRIBUTE_TASKS_INCOMPLETE && !is_task_incomplete(*task)) {
-              bool incomplete_subtasks = false;
-              List_iterator subtasks_iterator = iterator;
-              while (list_iterator_next(&subtasks_iterator)) {
-                  Task *sub_task = list_iterator_element(subtasks_iterator);
-                  if (sub_task->level <= task->level) break;
-                  if (is_task_incomplete(*sub_task)) {
-                      incomplete_subtasks = true;
-                      break;
-                  }
-              }
-
-              if (!incomplete_subtasks) continue;
-          }
+          if (attribute == TODO_ATTRIBUTE_TASKS_INCOMPLETE && !is_task_incomplete(*task) && !task_has_incomplete_subtasks(*task)) continue;
 
           for (unsigned int x = 0; x < task->level * info_level_indentation; x++) putc(' ', stdout);
           printf("    %s-%s ", ANSI_RED, ANSI_RESET);
@@ -164,22 +153,11 @@ bool print_todo(unsigned int index, Todo *todo, Todo_print_attributes attribute)
 }
 
 bool clone_text_file(char *origin_path, char *clone_path) {
-  FILE *origin = fopen(origin_path, "r");
-  if (!origin) {
-    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to open '%s'", origin_path);
-    return false;
-  }
-  FILE *clone = fopen(clone_path, "w");
-  if (!clone) {
-    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to open '%s'", clone_path);
+  if (!file_copy(origin_path, clone_path)) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to copy '%s' to '%s'", origin_path, clone_path);
     return false;
   }
 
-  int c; // int for EOF
-  while ( (c = fgetc(origin)) != EOF ) fputc(c, clone);
-
-  fclose(clone);
-  fclose(origin);
   return true;
 }
 
@@ -188,63 +166,34 @@ bool write_notes_to_temporal_file(Todo *todo) {
 
   // Check if there's a notes file already present from another idea instance
   // that exited abnormally
-  FILE *f = fopen(notes_temp_path.str, "r");
-  if (f) {
+  if (access(notes_temp_path.str, F_OK) == 0) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "It seems that idea didn't finish correctly while writing some notes. Please check the content of '%s' and either move or remove the file", notes_temp_path.str);
     sb_free(&notes_temp_path);
-    fclose(f);
     return false;
   }
 
-  f = fopen(notes_temp_path.str, "w");
-  if (!f) {
-    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to open '%s'", notes_temp_path.str);
+  if (!file_write_all(notes_temp_path.str, todo->notes, strlen(todo->notes), true)) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "An error ocurred while writing to the note's temporal file '%s'", notes_temp_path.str);
     sb_free(&notes_temp_path);
     return false;
   }
-  sb_free(&notes_temp_path);
-
-  if (fputs(todo->notes, f) == EOF) {
-    fclose(f);
-    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "An error ocurred while writing to the note's temporal file");
-    return false;
-  }
 
-  fclose(f);
+  sb_free(&notes_temp_path);
   return true;
 }
 
 bool load_notes_from_temporal_file(Todo *todo) {
   String_builder notes_temp_path = sb_create("%s/" NOTES_TEMP_FILENAME, idea_state.local_path);
-  FILE *f = fopen(notes_temp_path.str, "r");
-  if (!f) {
-    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to open '%s'", notes_temp_path.str);
-    sb_free(&notes_temp_path);
-    return false;
-  }
-
-  long size = 0;
-  if ( fseek(f, 0, SEEK_END) == -1
-       || (size = ftell(f)) == -1
-       || fseek(f, 0, SEEK_SET) == -1) {
-    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to get the length of the file '%s'", notes_temp_path.str);
-    sb_free(&notes_temp_path);
-    fclose(f);
-    return false;
-  }
 
-  if (todo->notes) free(todo->notes);
-  todo->notes = malloc(size+1);
-  if (!todo->notes) return false;
-  if (fread(todo->notes, size, 1, f) == 0) {
+  char *notes = file_read_all(notes_temp_path.str, NULL);
+  if (!notes) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to read the file '%s'", notes_temp_path.str);
     sb_free(&notes_temp_path);
-    fclose(f);
     return false;
   }
-  todo->notes[size] = '\0';
 
-  fclose(f);
+  todo_set_notes(todo, notes);
+
   if (remove(notes_temp_path.str) == -1) APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to remove the temporary notes file: %s", notes_temp_path.str);
   sb_free(&notes_temp_path);
   return true;
@@ -336,7 +285,15 @@ bool action_list_todos(Input *input) {
     }
   }
 
+  // The attributes are built in parallel before printing the ToDos
+  if ((attribute != TODO_ATTRIBUTE_NONE || filter_tag) && !build_attributes_of_todo_list(todo_list)) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to load the attributes of the ToDos");
+    free(filter_tag);
+    return false;
+  }
+
   if (filter_tag) printf("%sTAG: %s%s\n", ANSI_GRAY, filter_tag, ANSI_RESET);
+  const char *interned_filter_tag = intern(filter_tag); // The tags are compared by pointer
 
   List_iterator iterator = list_iterator_create(todo_list);
   while (list_iterator_next(&iterator)) {
@@ -352,7 +309,7 @@ bool action_list_todos(Input *input) {
       bool tag_match = false;
       while (list_iterator_next(&tag_iterator)) {
         const char *tag = list_iterator_element(tag_iterator);
-        if (!strcmp(tag, filter_tag)) {
+        if (tag == interned_filter_tag) {
           tag_match = true;
           break;
         }
@@ -441,6 +398,48 @@ bool action_export_todos(Input *input) {
   return ret;
 }
 
+// Runs every line of `file` as a command and stops at the first one that
+// fails. With `acknowledge`, it writes "ok [line]" or "error [line]" to stdout
+// after each command, following what the command printed. The acknowledgements
+// go through the buffer of stdout, like the output of the commands, so they stay
+// in order, and long command streams don't pay a write per command. stdout is
+// flushed after every line when the input is a terminal.
+bool execute_commands_from_file(const char *file_path, FILE *cmds_file, bool acknowledge) {
+  const bool interactive = acknowledge && isatty(fileno(cmds_file));
+  bool ret = true;
+
+  unsigned int line_nr = 1;
+  String_builder line = sb_new();
+  while ( ret && (sb_read_line(cmds_file, &line)) ) {
+    if (!line.length) {
+      line_nr++;
+      continue;
+    }
+
+    ret = cli_parse_input(line.str);
+
+    if (!ret) {
+      APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "An error happened while executing the commands from %s:%u", file_path, line_nr);
+    } else if (acknowledge) {
+      // Informative messages would interleave with the acknowledgements
+      list_destroy(&backtrace, (void (*)(void *))free_backtrace_item);
+    }
+
+    if (acknowledge) {
+      printf("%s %u\n", (ret) ? "ok" : "error", line_nr);
+      if (interactive) fflush(stdout);
+    }
+
+    sb_clean(&line);
+    line_nr++;
+  }
+
+  if (acknowledge) fflush(stdout);
+
+  sb_free(&line);
+  return ret;
+}
+
 bool action_execute_commands(Input *input) {
   if (!input) abort();
 
@@ -463,33 +462,43 @@ bool action_execute_commands(Input *input) {
     free(import_path);
     return false;
   }
-  free(import_path); import_path = NULL;
 
-  unsigned int line_nr = 1;
-  String_builder line = sb_new();
-  while ( (sb_read_line(cmds_file, &line)) ) {
-    if (!line.length) {
-      line_nr++;
-      continue;
-    }
+  bool ret = execute_commands_from_file(import_path, cmds_file, false);
+  fclose(cmds_file);
+  free(import_path);
+  return ret;
+}
 
-    bool result;
-    result = cli_parse_input(line.str);
+bool action_batch_commands(Input *input) {
+  if (!input) abort();
 
-    if (!result) {
-      fclose(cmds_file);
-      APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "An error happened while executing the commands from %s:%u", line.str, line_nr);
-      sb_free(&line);
-      return false;
-    }
+  char *batch_path = next_token(input, ' ');
+  if (!batch_path) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Command malformed: You must specify the file path (or '-' for stdin)");
+    return false;
+  }
 
-    sb_clean(&line);
-    line_nr++;
+  char *left = NULL;
+  if (has_more_tokens(input, &left)) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "You provided too many arguments: %s", left);
+    free(batch_path);
+    return false;
   }
 
-  sb_free(&line);
-  fclose(cmds_file);
-  return true;
+  FILE *cmds_file = open_todo_list_file(batch_path, "r");
+  if (!cmds_file) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to open the file '%s'", batch_path);
+    free(batch_path);
+    return false;
+  }
+
+  // The output is the stream of acknowledgements, so don't print the list afterwards
+  cli_list_after_changes = false;
+
+  bool ret = execute_commands_from_file((cmds_file == stdin) ? "stdin" : batch_path, cmds_file, true);
+  close_todo_list_file(cmds_file);
+  free(batch_path);
+  return ret;
 }
 
 bool action_import_todos(Input *input) {
@@ -649,7 +658,8 @@ bool action_notes_todo(Input *input) {
   }
   free(todo_ref); todo_ref = NULL;
 
-  Todo *todo = list_get(todo_list, pos);
+  Todo *todo = todo_list_get_for_write(pos);
+  if (!todo) return false;
 
   if (!todo->notes) initialize_notes(todo);
 
@@ -908,6 +918,7 @@ bool action_reminders(Input *input) {
 
   if (filter_tag) {
     printf("%sTAG: %s%s\n", ANSI_GRAY, filter_tag, ANSI_RESET);
+    const char *interned_filter_tag = intern(filter_tag);
 
     List_iterator rem_iterator = list_iterator_create(reminders);
     while (list_iterator_next(&rem_iterator)) {
@@ -921,7 +932,7 @@ bool action_reminders(Input *input) {
       bool tag_match = false;
       while (list_iterator_next(&tag_iterator)) {
         const char *tag = list_iterator_element(tag_iterator);
-        if (!strcmp(tag, filter_tag)) {
+        if (tag == interned_filter_tag) {
           tag_match = true;
           break;
         }
@@ -970,6 +981,12 @@ bool action_tags(Input *input) {
   List tags = list_new();
   if (filter_tag) {
     printf("%sTAG: %s%s\n", ANSI_GRAY, filter_tag, ANSI_RESET);
+    const char *interned_filter_tag = intern(filter_tag);
+
+    if (!build_attributes_of_todo_list(todo_list)) {
+      free(filter_tag);
+      return false;
+    }
 
     List todo_list_filtered = list_new();
 
@@ -986,7 +1003,7 @@ bool action_tags(Input *input) {
       List_iterator tag_iterator = list_iterator_create(todo->attributes.tags);
       while (list_iterator_next(&tag_iterator)) {
         const char *tag = list_iterator_element(tag_iterator);
-        if (!strcmp(tag, filter_tag)) {
+        if (tag == interned_filter_tag) {
           list_append(&todo_list_filtered, todo);
           break;
         }
@@ -1017,6 +1034,148 @@ bool action_tags(Input *input) {
   return true;
 }
 
+bool action_stats(Input *input) {
+  char *left = NULL;
+  if (input && has_more_tokens(input, &left)) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "You provided too many arguments: %s", left);
+    return false;
+  }
+
+  const Todo_list_stats *stats = todo_list_stats();
+  if (!stats) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to compute the stats");
+    return false;
+  }
+
+  const unsigned int indentation = 4;
+  printf("ToDos: %u %s(%u with notes)%s\n", stats->todos, ANSI_GRAY, stats->todos_with_notes, ANSI_RESET);
+
+  const Task_counters tasks = stats->tasks;
+  if (tasks.total) {
+    printf("\nTasks: %u/%u done (%u%%)\n", tasks.done, tasks.total - tasks.removed, task_counters_progress(tasks));
+    printf("%*s%s[ ]%s %u pending\n",       indentation, "", ANSI_GRAY, ANSI_RESET, tasks.pending);
+    printf("%*s%s[-]%s %u working on it\n", indentation, "", ANSI_YELLOW, ANSI_RESET, tasks.working);
+    printf("%*s%s[?]%s %u questions\n",     indentation, "", ANSI_BLUE, ANSI_RESET, tasks.questions);
+    printf("%*s%s[x]%s %u done\n",          indentation, "", ANSI_GREEN, ANSI_RESET, tasks.done);
+    printf("%*s%s[~]%s %u removed\n",       indentation, "", ANSI_RED, ANSI_RESET, tasks.removed);
+  }
+
+  const Reminder_counters reminders = stats->reminders;
+  const unsigned int reminders_count = reminders.old + reminders.triggered + reminders.upcoming + reminders.later;
+  if (reminders_count) {
+    printf("\nReminders: %u\n", reminders_count);
+    printf("%*s%u old\n",       indentation, "", reminders.old);
+    printf("%*s%u triggered\n", indentation, "", reminders.triggered);
+    printf("%*s%u upcoming\n",  indentation, "", reminders.upcoming);
+    printf("%*s%u later\n",     indentation, "", reminders.later);
+  }
+
+  if (stats->tags) {
+    Tag_frequency *tags = todo_list_stats_tags();
+    printf("\nTags: %u\n", stats->tags);
+    for (unsigned int i = 0; i < stats->tags; i++) {
+      printf("%*s%s%s#%s %s %s(%u)%s\n", indentation, "", ANSI_GRAY, ANSI_ITALIC, ANSI_RESET, tags[i].tag, ANSI_GRAY, tags[i].count, ANSI_RESET);
+    }
+    free(tags);
+  }
+
+  if (stats->todos_with_tasks) {
+    printf("\nProgress:\n");
+    List_iterator iterator = list_iterator_create(todo_list);
+    while (list_iterator_next(&iterator)) {
+      const Todo *todo = list_iterator_element(iterator);
+      const Task_counters counters = todo->attributes.task_counters;
+      if (!counters.total) continue;
+
+      printf("%s%d)%s %s: %u/%u done (%u%%)\n", ANSI_RED, list_iterator_index(iterator) + 1, ANSI_RESET,
+          todo->name, counters.done, counters.total - counters.removed, task_counters_progress(counters));
+    }
+  }
+
+  return true;
+}
+
+bool action_search(Input *input) {
+  if (!input) abort();
+
+  // The arguments are joined, so the pattern doesn't need to be quoted
+  String_builder pattern = sb_new();
+  char *arg = NULL;
+  while ( (arg = next_token(input, ' ')) ) {
+    if (pattern.length) sb_append_char(&pattern, ' ');
+    sb_append(&pattern, arg);
+    free(arg);
+  }
+
+  if (!pattern.length) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Command malformed: You must specify what to search");
+    sb_free(&pattern);
+    return false;
+  }
+
+  List results = list_new();
+  if (!search_todos(pattern.str, &results)) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to search '%s'", pattern.str);
+    sb_free(&pattern);
+    return false;
+  }
+  sb_free(&pattern);
+
+  const unsigned int indentation = 4;
+  List_iterator iterator = list_iterator_create(results);
+  while (list_iterator_next(&iterator)) {
+    const Search_result *result = list_iterator_element(iterator);
+    printf("%s%d)%s %s\n", ANSI_RED, result->position + 1, ANSI_RESET, result->todo->name);
+
+    // Print each line that matches
+    const char *line = result->todo->notes;
+    unsigned long line_nr = 1;
+    List_iterator lines_iterator = list_iterator_create(result->lines);
+    while (list_iterator_next(&lines_iterator)) {
+      const unsigned long match_nr = (unsigned long) list_iterator_element(lines_iterator);
+      for (; line_nr < match_nr; line_nr++) line = strchr(line, '\n') + 1;
+
+      const char *end = strchr(line, '\n');
+      const int length = (end) ? end - line : (int) strlen(line);
+      printf("%*s%s%lu:%s %.*s\n", indentation, "", ANSI_GRAY, match_nr, ANSI_RESET, length, line);
+    }
+  }
+  free_search_results(&results);
+
+  return true;
+}
+
+bool action_find(Input *input) {
+  if (!input) abort();
+
+  String_builder pattern = sb_new();
+  char *arg = NULL;
+  while ( (arg = next_token(input, ' ')) ) {
+    if (pattern.length) sb_append_char(&pattern, ' ');
+    sb_append(&pattern, arg);
+    free(arg);
+  }
+
+  if (!pattern.length) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Command malformed: You must specify what to find");
+    sb_free(&pattern);
+    return false;
+  }
+
+  Fuzzy_index index;
+  Fuzzy_match matches[CLI_FIND_RESULTS];
+  todo_list_fuzzy_index_init(&index);
+  const unsigned int found = fuzzy_search(&index, pattern.str, matches, CLI_FIND_RESULTS);
+  sb_free(&pattern);
+
+  for (unsigned int i = 0; i < found && i < CLI_FIND_RESULTS; i++) {
+    printf("%s%d)%s %s\n", ANSI_RED, matches[i].index + 1, ANSI_RESET, index.names[matches[i].index]);
+  }
+  todo_list_fuzzy_index_free(&index);
+
+  return true;
+}
+
 bool action_print_new_line(Input *input) {
   ACTION_NO_ARGS("print_new_line", input);
   printf("\n");
@@ -1098,15 +1257,19 @@ Functionality cli_functionality[] = {
   { "print_new_line", NULL, action_print_new_line, MAN("Prints a new line. Just that...", "") },
   { "list", "-l", action_list_todos, MAN("List all ToDos", "", "tasks", "tasks incomplete", "tags", "reminders", "tag [tag_name]", "tasks tag [tag_name]", "tasks incomplete tag [tag_name]", "tags tag [tag_name]", "reminders tag [tag_name]") },
   { "execute", NULL, action_execute_commands, MAN("Execute a list of idea commands from a text file", "[path]")},
-  { "export", NULL, action_export_todos, MAN("Export the ToDos to a text file", "[path]") },
+  { "batch", NULL, action_batch_commands, MAN("Execute the commands of a text file (use '-' for stdin), acknowledging each one with 'ok [line]' or 'error [line]'", "[path]", "-")},
+  { "export", NULL, action_export_todos, MAN("Export the ToDos to a text file (use '-' for stdout)", "[path]", "-") },
   { "sync", NULL, action_sync_todos, MAN("Check and import the ToDos from a text file generated by idea", "[path]") },
-  { "import", NULL, action_import_todos, MAN("Import the ToDos without any interaction (no diff)", "[path]") },
+  { "import", NULL, action_import_todos, MAN("Import the ToDos without any interaction (no diff). Use '-' to read them from stdin", "[path]", "-") },
   { "help", "-h", action_print_help, MAN("Help page", NULL) },
   { "notes", NULL, action_notes_todo, MAN("Open the ToDo notes", "[todo]") },
   { "notes_print", NULL, action_print_notes, MAN("Print the ToDo notes", "[todo]", "[todo] numbers") },
   { "loop", NULL, action_loop, MAN("Go into the CLI loop. You can execute `rlwrap idea loop` for a better experience", NULL) },
   { "reminders", "rem", action_reminders, MAN("See the reminders", "", "triggered", "near", "tag [tag_name]", "triggered tag [tag_name]", "near tag [tag_name]") },
   { "tags", NULL, action_tags, MAN("See the tags being used", "", "tag [tag_name]") },
+  { "search", NULL, action_search, MAN("Search a text in the names and notes of the ToDos (case insensitive), printing the lines that match", "[text]") },
+  { "find", NULL, action_find, MAN("Fuzzy find the ToDos by their names, printing the best matches first", "[text]") },
+  { "stats", NULL, action_stats, MAN("See the number of ToDos, tasks by state, reminders and tag frequencies", "") },
   { "generate_autocomplete", NULL, action_generate_autocomplete, MAN("Generate autocompletion files for the shell", "", "bash [path]", "zsh [path]") },
 #ifdef COMMIT
   { "version", "-v", action_version, MAN("Print the commit hash and version", NULL) },
@@ -1115,6 +1278,22 @@ Functionality cli_functionality[] = {
 unsigned int cli_functionality_count = sizeof(cli_functionality) / sizeof(Functionality);
 
 /// Parsing
+Dispatch_table cli_dispatch_table = {0};
+bool cli_dispatch_table_ready = false;
+
+void _cli_dispatch_table_init() {
+  if (cli_dispatch_table_ready) return;
+  cli_dispatch_table_ready = true;
+
+  // The CLI commands have priority over the generic ones
+  if (!dispatch_table_register(&cli_dispatch_table, cli_functionality, cli_functionality_count)) abort();
+  if (!dispatch_table_register(&cli_dispatch_table, todo_list_functionality, todo_list_functionality_count)) abort();
+}
+
+bool cli_register_functionality(Functionality functionality[], unsigned int functionality_count) {
+  _cli_dispatch_table_init();
+  return dispatch_table_register(&cli_dispatch_table, functionality, functionality_count);
+}
 
 bool cli_parse_input(char *input) {
   Input cmd = {
@@ -1122,31 +1301,31 @@ bool cli_parse_input(char *input) {
     .length = strlen(input),
     .cursor = 0,
   };
-  char *instruction = NULL;
-  while ( !(instruction = next_token(&cmd, ' ')) );
+  Token_view token;
+  while ( !next_token_view(&cmd, ' ', &token) );
 
-  bool (*function)(Input *input) = search_functionality_function(instruction, cli_functionality, cli_functionality_count);
-  if (!function) {
-    function = search_functionality_function(instruction, todo_list_functionality, todo_list_functionality_count);
-  }
+  // The commands are short, so a longer instruction can't match any of them
+  // even when it's truncated
+  char instruction[CLI_INSTRUCTION_SIZE];
+  token_view_unescape(token, ' ', instruction, sizeof(instruction));
+
+  _cli_dispatch_table_init();
+  const Functionality *functionality = dispatch_table_search(&cli_dispatch_table, instruction);
+  bool (*function)(Input *input) = (functionality) ? functionality->function_cmd : NULL;
 
   if (!function) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unknown command '%s'", instruction);
-    free(instruction);
     return false;
   }
 
   if (function(&cmd)) {
     if (cmd.cursor <= cmd.length) {
       APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Command parsing error. There are arguments left without processing in the instruction. Instruction: '%s'", instruction);
-      free(instruction);
       return false;
     }
-    free(instruction);
     return true;
   } else {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Command '%s' failed", instruction);
-    free(instruction);
     return false;
   }
 }
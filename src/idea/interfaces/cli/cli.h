@@ -12,6 +12,9 @@
 #define BOX_H_BAR "─"
 #define BOX_T "┬"
 
+#define CLI_INSTRUCTION_SIZE 128
+#define CLI_FIND_RESULTS 10
+
 #define TEXT_EDITOR "nvim"
 #define DIFFTOOL_CMD "nvim -d"
 
@@ -35,6 +38,7 @@
 #define DIFF_CMD_ARGS DIFF_FORMAT_ARGS, DIFF_FORMAT_ARGS, DIFF_FORMAT_ARGS
 
 extern bool cli_disable_colors;
+extern bool cli_list_after_changes; // Print the ToDo list when the commands modified it
 
 void cli_print_backtrace();
 
@@ -47,6 +51,7 @@ bool action_export_todos(Input *input);
 bool action_notes_todo(Input *input);
 bool action_print_notes(Input *input);
 bool action_execute_commands(Input *input);
+bool action_batch_commands(Input *input);
 bool action_print_help(Input *input);
 bool action_loop(Input *input);
 extern Functionality cli_functionality[];
@@ -58,6 +63,12 @@ bool load_notes_from_temporal_file(Todo *todo);
 
 bool clone_text_file(char *origin_path, char *clone_path);
 
+bool execute_commands_from_file(const char *file_path, FILE *cmds_file, bool acknowledge);
+
+// Makes the commands of another module available to cli_parse_input. The
+// built-in commands keep the priority if the names collide
+bool cli_register_functionality(Functionality functionality[], unsigned int functionality_count);
+
 bool cli_parse_input(char *input);
 
 #endif // CLI_H
@@ -3,7 +3,10 @@
 #include <stdlib.h>
 
 #include "tui.h"
+#include "tui_preview.h"
+#include "tui_profiler.h"
 #include "../../main.h"
+#include "../../todos/notes_parser.h"
 #include "../../utils/backtrace.h"
 #include "../../../utils/tokenizer.h"
 #include "../../../utils/list.h"
@@ -20,12 +23,12 @@ Tui_state tui_st = {0};
 
 void redraw_map_status() {
   for (unsigned int x = 0; x < MAX_COMMAND_MULTIPLIER_LENGTH + MAP_BUFFER_SIZE; x++) {
-    mvaddch(area_start.y, area_start.x + area_size.width - x, ' ');
+    tui_mvaddch(area_start.y, area_start.x + area_size.width - x, ' ');
   }
   if (tui_st.command_multiplier != 0) {
-    mvprintw(area_start.y, area_start.x + area_size.width - strlen(tui_st.map_buffer) - MAX_COMMAND_MULTIPLIER_LENGTH, "%u", tui_st.command_multiplier);
+    tui_mvprintw(area_start.y, area_start.x + area_size.width - strlen(tui_st.map_buffer) - MAX_COMMAND_MULTIPLIER_LENGTH, "%u", tui_st.command_multiplier);
   }
-  mvprintw(area_start.y, area_start.x + area_size.width - strlen(tui_st.map_buffer), "%s", tui_st.map_buffer);
+  tui_mvprintw(area_start.y, area_start.x + area_size.width - strlen(tui_st.map_buffer), "%s", tui_st.map_buffer);
 }
 
 void add_to_command_multiplier(int n) {
@@ -34,13 +37,38 @@ void add_to_command_multiplier(int n) {
   tui_st.command_multiplier = ((tui_st.command_multiplier * 10) + n) % max_command_multiplier;
 }
 
+// Left of the ToDo: '!' if a reminder is triggered, and the tasks done or
+// '*' if it only has notes. ".." while its attributes are being built and
+// "err" if its notes can't be parsed
+void draw_indicators(Todo *todo, unsigned int y) {
+  if (!todo->notes) return;
+
+  char indicators[32] = "..";
+  if (!todo->attributes_pending && todo->attributes.failed) { // Written by the background build until then
+    snprintf(indicators, sizeof(indicators), "err");
+  } else if (todo_attributes_ready(todo)) {
+    const Attributes *attributes = &todo->attributes;
+    // The triggered reminders are sorted first
+    const Reminder *reminder = (list_is_empty(attributes->reminders)) ? NULL : list_get(attributes->reminders, 0);
+    const char *triggered = (reminder && is_reminder_triggered(*reminder)) ? "! " : "";
+
+    const unsigned int tasks = attributes->task_counters.total - attributes->task_counters.removed;
+    if (tasks) snprintf(indicators, sizeof(indicators), "%s%u/%u", triggered, attributes->task_counters.done, tasks);
+    else snprintf(indicators, sizeof(indicators), "%s*", triggered);
+  }
+
+  const unsigned int length = strlen(indicators);
+  if (length + 1 > area_start.x) return;
+  tui_mvprintw(y, area_start.x - length - 1, "%s", indicators);
+}
+
 void draw_window(void) {
-  int status_line_height = 2;
   const char *cursor = "--> ";
   const unsigned int cursor_length = strlen(cursor);
   const char *command = ":";
   const char *visual = "-- VISUAL --";
   const char *changed = "[+]";
+  const char *saving = "[saving]";
 
   // Area box
   // draw_rect(area_start.y - 1,
@@ -49,58 +77,93 @@ void draw_window(void) {
   //           area_start.x + area_size.width);
 
   if (todo_list_modified) {
-    mvprintw(area_start.y, area_start.x, "%s", changed);
+    tui_mvprintw(area_start.y, area_start.x, "%s", changed);
+  }
+
+  // Hands the attributes built in the background to this thread
+  const bool building_attributes = todo_list_attributes_in_progress();
+  const bool save_running = todo_list_save_in_progress();
+  tui_st.drawn_in_background = building_attributes || save_running;
+
+  if (save_running) {
+    // Left of the area, or after the changed indicator if it doesn't fit
+    // (the command input takes that place in command mode)
+    if (strlen(saving) + 1 <= area_start.x) {
+      tui_mvprintw(area_start.y, area_start.x - strlen(saving) - 1, "%s", saving);
+    } else if (tui_st.mode != MODE_COMMAND) {
+      tui_mvprintw(area_start.y, area_start.x + strlen(changed) + 1, "%s", saving);
+    }
   }
 
   if (tui_st.mode == MODE_COMMAND) {
-    mvprintw(area_start.y, area_start.x + cursor_length, "%s", command);
-    if (strcmp(tui_st.input, "")) printw("%s", tui_st.input);
+    tui_mvprintw(area_start.y, area_start.x + cursor_length, "%s", command);
+    if (strcmp(tui_st.input, "")) tui_printw("%s", tui_st.input);
   }
 
   if (tui_st.mode == MODE_VISUAL) {
-    mvprintw(area_start.y, area_start.x + (area_size.width - strlen(visual))/2, "%s", visual);
+    tui_mvprintw(area_start.y, area_start.x + (area_size.width - strlen(visual))/2, "%s", visual);
   }
 
-  // Print all items
-  List_iterator iterator = list_iterator_create(todo_list);
-  while (list_iterator_next(&iterator)) {
-    const Todo *todo = list_iterator_element(iterator);
-    const unsigned int index = list_iterator_index(iterator);
-    const bool is_selected = list_contains(tui_st.selected, todo);
-
-    if (is_selected) attron(A_REVERSE);
-
-    mvprintw(area_start.y+index + status_line_height,
-             area_start.x + cursor_length,
-             "%d) %s", index + 1, todo->name);
-
-
-    if (is_selected) attroff(A_REVERSE);
-  }
+  // Print only the visible items. ncurses compares the screen with the
+  // previous one on refresh, so only the lines that changed are sent to the
+  // terminal
+  update_viewport();
+  if (!list_is_empty(todo_list)) {
+    const unsigned int rows = visible_rows();
+    const List_node *node = list_node_get(todo_list, tui_st.first_visible_pos);
+    Todo *current = NULL;
+    for (unsigned int row = 0; node && row < rows; row++, node = node->next) {
+      Todo *todo = node->pointer;
+      const unsigned int index = tui_st.first_visible_pos + row;
+      if (index == tui_st.current_pos) current = todo;
+      const bool is_selected = pointer_set_contains(&tui_st.selected, todo);
+
+      if (is_selected) tui_attron(A_REVERSE);
+
+      tui_mvprintw(area_start.y + row + STATUS_LINE_HEIGHT,
+               area_start.x + cursor_length,
+               "%d) %s", index + 1, todo->name);
+
+      if (is_selected) tui_attroff(A_REVERSE);
+
+      draw_indicators(todo, area_start.y + row + STATUS_LINE_HEIGHT);
+    }
 
-  // Cursor
-  if (list_size(todo_list)) {
-    mvprintw(area_start.y + tui_st.current_pos + status_line_height,
+    // Cursor
+    tui_mvprintw(area_start.y + (tui_st.current_pos - tui_st.first_visible_pos) + STATUS_LINE_HEIGHT,
         area_start.x,
         "%s", cursor);
+
+    if (tui_st.show_notes_preview && current) {
+      // Right of the area, over the end of the long names
+      const unsigned int separator_x = area_start.x + area_size.width + 1;
+      for (unsigned int y = 0; y < window_size.height; y++) {
+        tui_move(y, separator_x);
+        tui_clrtoeol();
+      }
+      tui_mvvline(0, separator_x, 0, window_size.height);
+      if (window_size.width > separator_x + 3) {
+        draw_notes_preview(current, 0, separator_x + 2, window_size.height, window_size.width - separator_x - 3);
+      }
+    }
   }
 
   redraw_map_status();
 
   if (tui_st.mode == MODE_COMMAND) {
-    move(area_start.y, area_start.x + cursor_length + strlen(command) + tui_st.input_cursor);
+    tui_move(area_start.y, area_start.x + cursor_length + strlen(command) + tui_st.input_cursor);
   }
 }
 
 void draw_rect(int y1, int x1, int y2, int x2) {
-    mvhline(y1, x1, 0, x2-x1);
-    mvhline(y2, x1, 0, x2-x1);
-    mvvline(y1, x1, 0, y2-y1);
-    mvvline(y1, x2, 0, y2-y1);
-    mvaddch(y1, x1, ACS_ULCORNER);
-    mvaddch(y2, x1, ACS_LLCORNER);
-    mvaddch(y1, x2, ACS_URCORNER);
-    mvaddch(y2, x2, ACS_LRCORNER);
+    tui_mvhline(y1, x1, 0, x2-x1);
+    tui_mvhline(y2, x1, 0, x2-x1);
+    tui_mvvline(y1, x1, 0, y2-y1);
+    tui_mvvline(y1, x2, 0, y2-y1);
+    tui_mvaddch(y1, x1, ACS_ULCORNER);
+    tui_mvaddch(y2, x1, ACS_LLCORNER);
+    tui_mvaddch(y1, x2, ACS_URCORNER);
+    tui_mvaddch(y2, x2, ACS_LRCORNER);
 }
 
 char message(char *title, char *msg) {
@@ -122,6 +185,12 @@ char message(char *title, char *msg) {
     if (line_length > max_line_length) max_line_length = line_length;
   }
 
+  // Taller than the window
+  if (4 /* 2 (box borders) + 1 (title line) + 1 (title) */ + padding.height * 2 + lines > window_size.height) {
+    const char *cursor = msg;
+    return pager(title, pager_string_iterator(&cursor));
+  }
+
   Size box_size = {
     .width = max_line_length + padding.width * 2,
     .height = 4 /* 2 (box borders) + 1 (title line) + 1 (title) */ + padding.height * 2 + lines,
@@ -138,21 +207,21 @@ char message(char *title, char *msg) {
   if (box_start.x > window_size.width) box_start.x = 0;
   if (box_start.y > window_size.height) box_start.y = 0;
 
-  erase();
+  tui_erase();
 
   // Title bar
-  mvhline(box_start.y + 2,
+  tui_mvhline(box_start.y + 2,
           box_start.x,
           0,
           box_size.width - 1);
-  mvaddch(box_start.y + 2,
+  tui_mvaddch(box_start.y + 2,
           box_start.x,
           ACS_LTEE);
-  mvaddch(box_start.y + 2,
+  tui_mvaddch(box_start.y + 2,
           box_start.x + box_size.width - 1,
           ACS_RTEE);
 
-  mvprintw(box_start.y + 1,
+  tui_mvprintw(box_start.y + 1,
            box_start.x + (box_size.width - strlen(title))/2,
            "%s", title);
 
@@ -162,17 +231,17 @@ char message(char *title, char *msg) {
   bool strange_character = false; // For example accented characters
   unsigned int cur_y = start_y,
                cur_x = start_x;
-  move(cur_y, cur_x);
+  tui_move(cur_y, cur_x);
   for (unsigned int i=0; i<msg_len; i++) {
     if (msg[i] == '\n' || (cur_x - start_x) == line_length_limit) {
       cur_y++;
       cur_x = start_x;
 
-      move(cur_y, cur_x);
+      tui_move(cur_y, cur_x);
     }
 
     if (msg[i] != '\n') {
-      printw("%c", msg[i]);
+      tui_printw("%c", msg[i]);
       if (msg[i] < 0) strange_character = true;
       cur_x++;
     }
@@ -188,7 +257,175 @@ char message(char *title, char *msg) {
         );
   }
 
-  return getch();
+  return tui_getch();
+}
+
+/// PAGER
+// The lines are requested to the iterator and wrapped only when a row of
+// theirs has to be shown, so the cost of showing a page doesn't depend on the
+// length of the content
+typedef struct {
+  unsigned int line;   // Index in Pager.lines
+  unsigned int offset; // Of the first character of the row in the line
+  unsigned int length;
+} Pager_row;
+
+typedef struct {
+  Pager_iterator iterator;
+  bool finished; // The iterator has no more lines
+  unsigned int width;
+
+  char **lines;
+  unsigned int lines_count;
+  unsigned int lines_capacity;
+
+  Pager_row *rows; // Wrapped to `width`
+  unsigned int rows_count;
+  unsigned int rows_capacity;
+} Pager;
+
+void _pager_add_row(Pager *pager, unsigned int line, unsigned int offset, unsigned int length) {
+  if (pager->rows_count == pager->rows_capacity) {
+    pager->rows_capacity = (pager->rows_capacity) ? pager->rows_capacity*2 : 64;
+    pager->rows = realloc(pager->rows, pager->rows_capacity * sizeof(Pager_row));
+    if (!pager->rows) abort();
+  }
+  pager->rows[pager->rows_count++] = (Pager_row) { .line = line, .offset = offset, .length = length };
+}
+
+void _pager_wrap_line(Pager *pager, unsigned int line) {
+  const unsigned int length = strlen(pager->lines[line]);
+  if (!length) _pager_add_row(pager, line, 0, 0);
+  for (unsigned int offset = 0; offset < length; offset += pager->width) {
+    _pager_add_row(pager, line, offset, (length - offset < pager->width) ? length - offset : pager->width);
+  }
+}
+
+// Wraps lines until there are `rows` rows or the content ends
+void _pager_layout(Pager *pager, unsigned int rows) {
+  String_builder sb = sb_new();
+  while (pager->rows_count < rows && !pager->finished) {
+    sb_clean(&sb);
+    if (!pager->iterator.next(pager->iterator.state, &sb)) {
+      pager->finished = true;
+      break;
+    }
+
+    if (pager->lines_count == pager->lines_capacity) {
+      pager->lines_capacity = (pager->lines_capacity) ? pager->lines_capacity*2 : 64;
+      pager->lines = realloc(pager->lines, pager->lines_capacity * sizeof(char *));
+      if (!pager->lines) abort();
+    }
+    pager->lines[pager->lines_count] = strdup((sb.str) ? sb.str : "");
+    if (!pager->lines[pager->lines_count]) abort();
+    _pager_wrap_line(pager, pager->lines_count++);
+  }
+  sb_free(&sb);
+}
+
+// The lines that were already read are wrapped again (e.g. the window was resized)
+void _pager_set_width(Pager *pager, unsigned int width) {
+  pager->width = width;
+  pager->rows_count = 0;
+  for (unsigned int line = 0; line < pager->lines_count; line++) _pager_wrap_line(pager, line);
+}
+
+void _pager_free(Pager *pager) {
+  for (unsigned int line = 0; line < pager->lines_count; line++) free(pager->lines[line]);
+  free(pager->lines);
+  free(pager->rows);
+}
+
+int pager(char *title, Pager_iterator iterator) {
+  const Size padding = { .width = 3, .height = 1 };
+  const unsigned int chrome_height = 4 /* 2 (box borders) + 1 (title line) + 1 (title) */ + padding.height * 2 + 1 /* footer */;
+
+  Pager pager = { .iterator = iterator };
+  unsigned int top = 0; // First visible row
+  int key = 0;
+
+  keypad(stdscr, TRUE);
+  while (true) {
+    window_size.width = getmaxx(stdscr);
+    window_size.height = getmaxy(stdscr);
+
+    const unsigned int box_width = window_size.width - padding.width * 2;
+    if (pager.width != box_width - padding.width * 2) {
+      // Keep the same line at the top
+      const unsigned int top_line = (top < pager.rows_count) ? pager.rows[top].line : 0;
+      _pager_set_width(&pager, box_width - padding.width * 2);
+      for (top = 0; top < pager.rows_count && pager.rows[top].line < top_line; top++);
+    }
+
+    const unsigned int page = (window_size.height > chrome_height) ? window_size.height - chrome_height : 1;
+
+    // Rows of the page and one more to know if it's the last one
+    _pager_layout(&pager, top + page + 1);
+    if (top + page > pager.rows_count) top = (pager.rows_count > page) ? pager.rows_count - page : 0;
+    const unsigned int visible = (pager.rows_count - top < page) ? pager.rows_count - top : page;
+
+    const Size box_size = { .width = box_width, .height = chrome_height + visible };
+    const Point box_start = {
+      .x = (window_size.width - box_size.width)/2,
+      .y = (window_size.height > box_size.height) ? (window_size.height - box_size.height)/2 : 0,
+    };
+
+    tui_erase();
+    tui_mvhline(box_start.y + 2, box_start.x, 0, box_size.width - 1);
+    tui_mvaddch(box_start.y + 2, box_start.x, ACS_LTEE);
+    tui_mvaddch(box_start.y + 2, box_start.x + box_size.width - 1, ACS_RTEE);
+    tui_mvprintw(box_start.y + 1, box_start.x + (box_size.width - strlen(title))/2, "%s", title);
+
+    const unsigned int start_y = box_start.y + 1 + padding.height + 2,
+                       start_x = box_start.x + padding.width;
+    for (unsigned int i = 0; i < visible; i++) {
+      const Pager_row row = pager.rows[top + i];
+      tui_mvaddnstr(start_y + i, start_x, pager.lines[row.line] + row.offset, row.length);
+    }
+
+    const bool at_end = pager.finished && top + visible >= pager.rows_count;
+    char footer[64];
+    snprintf(footer, sizeof(footer), "%u-%u%s  j/k PgUp/PgDn: scroll  Other: close",
+             (visible) ? top + 1 : 0, top + visible, (at_end) ? "" : "+");
+    tui_mvaddnstr(start_y + visible + padding.height - 1, start_x, footer, pager.width);
+    draw_rect(box_start.y, box_start.x, box_start.y + box_size.height - 1, box_start.x + box_size.width - 1);
+
+    key = tui_getch();
+    if (key == 'j' || key == KEY_DOWN) {
+      if (!at_end) top++;
+    } else if (key == 'k' || key == KEY_UP) {
+      if (top) top--;
+    } else if (key == KEY_NPAGE) {
+      if (!at_end) top += page;
+    } else if (key == KEY_PPAGE) {
+      top = (top > page) ? top - page : 0;
+    } else if (key != KEY_RESIZE) {
+      break;
+    }
+  }
+  keypad(stdscr, FALSE);
+
+  _pager_free(&pager);
+  return key;
+}
+
+bool _pager_string_next(void *state, String_builder *line) {
+  const char **cursor = state;
+  if (!*cursor) return false;
+
+  const char *end = strchr(*cursor, '\n');
+  if (!end) {
+    sb_append(line, *cursor);
+    *cursor = NULL;
+  } else {
+    sb_append_n(line, *cursor, end - *cursor);
+    *cursor = end + 1;
+  }
+  return true;
+}
+
+Pager_iterator pager_string_iterator(const char **cursor) {
+  return (Pager_iterator) { .next = _pager_string_next, .state = cursor };
 }
 
 bool confirm(char *msg, Confirm_type type) {
@@ -271,13 +508,13 @@ void command_input_adjust_around(int *start, int *end, int input_length) {
 void command_input_remove(int *input_cursor, int *input_length, int *screen_x, int screen_y, int start, int end) {
   *screen_x -= (*input_cursor - start);
 
-  move(screen_y, *screen_x);
+  tui_move(screen_y, *screen_x);
   for (int x = 0; x < *input_length - end; x++) {
-    if (x != *input_length - end - 1) addch(tui_st.input[(end+1)+x]);
+    if (x != *input_length - end - 1) tui_addch(tui_st.input[(end+1)+x]);
     tui_st.input[start+x] = tui_st.input[(end+1)+x];
   }
-  for (int x = 0; x <= (end+1) - start; x++) addch(' ');
-  move(screen_y, *screen_x);
+  for (int x = 0; x <= (end+1) - start; x++) tui_addch(' ');
+  tui_move(screen_y, *screen_x);
   *input_length -= (end+1) - start;
   *input_cursor = start;
 }
@@ -299,9 +536,26 @@ void command_input_remove_word(int *cursor, int *length, int *screen_x, int scre
 void command_input_refresh_characters(int chars_to_clear, int screen_y, int *screen_x, int *input_cursor, int input_len) {
   *screen_x -= chars_to_clear;
   for (int z=0; z < chars_to_clear; z++) {
-    mvprintw(screen_y, *screen_x + z, "%c", (*input_cursor+z >= input_len) ? ' ' : tui_st.input[*input_cursor+z]);
+    tui_mvprintw(screen_y, *screen_x + z, "%c", (*input_cursor+z >= input_len) ? ' ' : tui_st.input[*input_cursor+z]);
   }
-  move(screen_y, *screen_x);
+  tui_move(screen_y, *screen_x);
+}
+
+Dispatch_table tui_dispatch_table = {0};
+bool tui_dispatch_table_ready = false;
+
+void _tui_dispatch_table_init() {
+  if (tui_dispatch_table_ready) return;
+  tui_dispatch_table_ready = true;
+
+  // The TUI commands overwrite the generic ones (e.g. add_at)
+  if (!dispatch_table_register(&tui_dispatch_table, tui_functionality, tui_functionality_count)) abort();
+  if (!dispatch_table_register(&tui_dispatch_table, todo_list_functionality, todo_list_functionality_count)) abort();
+}
+
+bool tui_register_functionality(Functionality functionality[], unsigned int functionality_count) {
+  _tui_dispatch_table_init();
+  return dispatch_table_register(&tui_dispatch_table, functionality, functionality_count);
 }
 
 bool parse_command() {
@@ -311,12 +565,12 @@ bool parse_command() {
   int x = getcurx(stdscr), y = getcury(stdscr);
   while (read) {
     switch (tui_st.command_input_mode) {
-      case COMMAND_INPUT_NORMAL: mvprintw(y, area_start.x, "[N]"); break;
-      case COMMAND_INPUT_INSERT: mvprintw(y, area_start.x, "[I]"); break;
+      case COMMAND_INPUT_NORMAL: tui_mvprintw(y, area_start.x, "[N]"); break;
+      case COMMAND_INPUT_INSERT: tui_mvprintw(y, area_start.x, "[I]"); break;
     }
-    move(y, x);
+    tui_move(y, x);
 
-    c = getch();
+    c = tui_getch();
     x = getcurx(stdscr);
 
     unsigned int chars_to_clear = 0;
@@ -330,7 +584,7 @@ bool parse_command() {
           command_input_refresh_characters(2, y, &x, &tui_st.input_cursor, tui_st.input_length); // for the ^? symbol of backspace
           if (tui_st.input_cursor > 0) {
             bool is_after_last_char = (tui_st.input_cursor > 1 && tui_st.input_cursor == tui_st.input_length);
-            move(y, --x); tui_st.input_cursor--;
+            tui_move(y, --x); tui_st.input_cursor--;
             c_map_remove_char(&tui_st.input_cursor, &tui_st.input_length, y, &x);
             // Only reset the position if the cursor was at the end of the
             // input, because when moving one position behind to remove the
@@ -341,16 +595,16 @@ bool parse_command() {
             // cursor can be one position ahead of the last character I need to
             // increment by one the cursor to make it one character ahead of the
             // input.
-            if (is_after_last_char) { move(y, ++x); tui_st.input_cursor++; }
+            if (is_after_last_char) { tui_move(y, ++x); tui_st.input_cursor++; }
           }
         } else if (C_INPUT_IS_VALID_INSERT_CHAR(c)) {
           if (tui_st.input_cursor != tui_st.input_length) {
-            for (int x = tui_st.input_cursor; x < tui_st.input_length; x++) addch(tui_st.input[x]);
+            for (int x = tui_st.input_cursor; x < tui_st.input_length; x++) tui_addch(tui_st.input[x]);
             for (int x = tui_st.input_length+1; x > tui_st.input_cursor; x--) tui_st.input[x] = tui_st.input[x-1];
           }
           tui_st.input[tui_st.input_cursor++] = c;
           tui_st.input_length++;
-          move(y, x);
+          tui_move(y, x);
         } else { // Not recognized character, so clear the character that was printed on the screen
           command_input_refresh_characters(1, y, &x, &tui_st.input_cursor, tui_st.input_length);
         }
@@ -373,24 +627,24 @@ bool parse_command() {
           case BACKSPACE_KEY:
             break;
 
-          default:
+          default: {
+            const Command_map *map = NULL;
             if (isdigit(c)) add_to_command_multiplier(c-'0');
-            else append_to_map_buffer(c);
+            else map = c_map_push_key(c);
             redraw_map_status();
-            move(y, x);
-
-            for (unsigned int z=0; z<c_maps_count; z++) {
-              if (!strcmp(tui_st.map_buffer, c_maps[z].keys)) {
-                do {
-                  c_maps[z].action(&tui_st.input_cursor, &tui_st.input_length, y, &x);
-                  if (tui_st.command_multiplier > 0) tui_st.command_multiplier--;
-                } while(tui_st.command_multiplier > 0);
-
-                clean_map();
-                redraw_map_status();
-              }
+            tui_move(y, x);
+
+            if (map) {
+              do {
+                map->action(&tui_st.input_cursor, &tui_st.input_length, y, &x);
+                if (tui_st.command_multiplier > 0) tui_st.command_multiplier--;
+              } while(tui_st.command_multiplier > 0);
+
+              clean_map();
+              redraw_map_status();
             }
             break;
+          }
         }
     }
 
@@ -423,14 +677,14 @@ bool parse_command() {
     char *instruction = NULL;
     while ( !(instruction = next_token(&cmd, ' ')) );
 
-    bool (*function)(Input *input) = search_functionality_function(instruction, tui_functionality, tui_functionality_count);
-    if (!function) {
-      function = search_functionality_function(instruction, todo_list_functionality, todo_list_functionality_count);
-    }
+    _tui_dispatch_table_init();
+    const Functionality *functionality = dispatch_table_search(&tui_dispatch_table, instruction);
+    bool (*function)(Input *input) = (functionality) ? functionality->function_cmd : NULL;
 
     if (!function) {
       APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unknown command '%s'", instruction);
     } else {
+      todo_list_attributes_wait(); // The commands use the attributes
       bool action_return = function(&cmd);
       if (action_return) {
         if (!list_is_empty(backtrace)) {
@@ -459,27 +713,49 @@ bool parse_command() {
   return true;
 }
 
+void replace_selected_todo(Todo *old, Todo *new) {
+  if (new) pointer_set_replace(&tui_st.selected, old, new);
+  else pointer_set_remove(&tui_st.selected, old);
+}
+
+void _unselect_released_todo(Todo *todo) {
+  replace_selected_todo(todo, NULL);
+}
+
 bool is_current_item_selected() {
   Todo *todo = list_get(todo_list, tui_st.current_pos);
-  return list_contains(tui_st.selected, todo);
+  return pointer_set_contains(&tui_st.selected, todo);
 }
 
 bool select_current_item() {
   Todo *todo = list_get(todo_list, tui_st.current_pos);
-  if (list_contains(tui_st.selected, todo)) return false;
-  list_append(&tui_st.selected, todo);
-  return true;
+  return pointer_set_add(&tui_st.selected, todo);
 }
 
 bool unselect_current_item() {
   Todo *todo = list_get(todo_list, tui_st.current_pos);
-  return (list_remove_element(&tui_st.selected, todo));
+  return pointer_set_remove(&tui_st.selected, todo);
 }
 
 void toggle_select_item() {
   if (!unselect_current_item()) select_current_item();
 }
 
+void update_selection_range(unsigned int first, unsigned int last, Selection_operation operation) {
+  if (first > last || last >= list_size(todo_list)) return;
+
+  const List_node *node = list_node_get(todo_list, first);
+  for (unsigned int i = first; i <= last; i++, node = node->next) {
+    switch (operation) {
+      case SELECTION_ADD:    pointer_set_add(&tui_st.selected, node->pointer);    break;
+      case SELECTION_REMOVE: pointer_set_remove(&tui_st.selected, node->pointer); break;
+      case SELECTION_TOGGLE:
+        if (!pointer_set_remove(&tui_st.selected, node->pointer)) pointer_set_add(&tui_st.selected, node->pointer);
+        break;
+    }
+  }
+}
+
 bool next_position() {
   if (list_size(todo_list) == 0 || tui_st.current_pos >= list_size(todo_list)-1) return false;
   tui_st.current_pos++;
@@ -492,14 +768,28 @@ bool previous_position() {
   return true;
 }
 
+void move_cursor(int offset) {
+  if (list_is_empty(todo_list)) return;
+
+  const long last = list_size(todo_list) - 1;
+  long pos = (long) tui_st.current_pos + offset;
+  if (pos < 0) pos = 0;
+  if (pos > last) pos = last;
+  tui_st.current_pos = pos;
+}
+
+bool _is_todo_unselected(void *todo) {
+  return !pointer_set_contains(&tui_st.selected, todo);
+}
+
 bool delete_selected() {
-  if (list_is_empty(tui_st.selected)) return false;
+  if (pointer_set_is_empty(&tui_st.selected)) return false;
 
   String_builder msg = sb_new();
   sb_append(&msg, "ToDos to remove:");
-  List_iterator iterator = list_iterator_create(tui_st.selected);
-  while (list_iterator_next(&iterator)) {
-    Todo *e = list_iterator_element(iterator);
+  Pointer_set_iterator iterator = pointer_set_iterator_create(&tui_st.selected);
+  while (pointer_set_iterator_next(&iterator)) {
+    Todo *e = pointer_set_iterator_element(iterator);
     sb_append_with_format(&msg, "\n  - %s", e->name);
   }
 
@@ -510,11 +800,8 @@ bool delete_selected() {
     return false;
   }
 
-  while (!list_is_empty(tui_st.selected)) {
-    Todo *e = list_remove(&tui_st.selected, 0);
-    list_remove_element(&todo_list, e);
-    free_todo(e);
-  }
+  list_filter(&todo_list, _is_todo_unselected, (void (*)(void *))release_todo);
+  pointer_set_clear(&tui_st.selected);
 
   // Reposition cursor if it's outside the bounds
   if (tui_st.current_pos > list_size(todo_list)-1) tui_st.current_pos = list_size(todo_list)-1;
@@ -534,63 +821,161 @@ void populate_command_input(const char *fmt, ...) {
   tui_st.input_cursor = tui_st.input_length;
 }
 
-bool move_selected(int direction) { // direction should be 1 or -1
-  if (direction != 1 && direction != -1) abort();
-  if (list_is_empty(tui_st.selected)) return false;
+unsigned int move_selected(int positions) {
+  const unsigned int size = list_size(todo_list);
+  if (!positions || pointer_set_is_empty(&tui_st.selected)) return 0;
 
-  Todo *limit_element = (direction == 1)
-                        ? list_get(todo_list, list_size(todo_list)-1)
-                        : list_get(todo_list, 0);
+  Todo **todos = malloc(size * sizeof(Todo *));
+  Todo **moved = calloc(size, sizeof(Todo *));
+  if (!todos || !moved) abort();
 
-  if (list_contains(tui_st.selected, limit_element)) return false;
-
-  int block_start = -1;
-  for (unsigned int i=0; i<list_size(todo_list); i++) {
-    Todo *e = list_get(todo_list, i);
-    if (!list_contains(tui_st.selected, e)) {
-      if (block_start == -1) continue;
+  unsigned int i = 0;
+  unsigned int first_selected = size, last_selected = 0;
+  List_iterator iterator = list_iterator_create(todo_list);
+  while (list_iterator_next(&iterator)) {
+    todos[i] = list_iterator_element(iterator);
+    if (pointer_set_contains(&tui_st.selected, todos[i])) {
+      if (first_selected == size) first_selected = i;
+      last_selected = i;
+    }
+    i++;
+  }
 
-      list_move_chunk(&todo_list, block_start, i-block_start, direction);
-      block_start = -1;
-      continue;
+  // Moving the blocks one position at a time keeps the gaps between them, and
+  // it stops when the first or the last ToDo of the list is selected. So
+  // every selected ToDo moves the same distance
+  const unsigned int requested = (positions > 0) ? positions : -positions;
+  const unsigned int available = (positions > 0) ? size-1 - last_selected : first_selected;
+  const unsigned int distance = (requested < available) ? requested : available;
+
+  if (first_selected != size && distance) {
+    for (i = 0; i < size; i++) {
+      if (!pointer_set_contains(&tui_st.selected, todos[i])) continue;
+      moved[(positions > 0) ? i + distance : i - distance] = todos[i];
     }
 
-    if (block_start == -1) {
-      block_start = i;
+    // The rest keep their order in the free positions
+    unsigned int free_pos = 0;
+    for (i = 0; i < size; i++) {
+      if (pointer_set_contains(&tui_st.selected, todos[i])) continue;
+      while (moved[free_pos]) free_pos++;
+      moved[free_pos] = todos[i];
     }
-  }
 
-  if (block_start != -1) {
-    list_move_chunk(&todo_list, block_start, (list_size(todo_list) - 1)-block_start + 1, direction);
+    i = 0;
+    for (List_node *node = todo_list.head; node; node = node->next) node->pointer = moved[i++];
   }
 
-  return true;
+  free(todos);
+  free(moved);
+  return (first_selected != size) ? distance : 0;
 }
 
-void visual_move_cursor(int direction) { // direction should be 1 or -1
-  if (direction != 1 && direction != -1) abort();
+void visual_move_cursor_to(unsigned int pos) {
   if (tui_st.mode != MODE_VISUAL) abort();
+  if (list_is_empty(todo_list)) return;
+  if (pos >= list_size(todo_list)) pos = list_size(todo_list)-1;
+
+  const Selection_operation apply = (tui_st.visual_mode == VISUAL_SELECT) ? SELECTION_ADD : SELECTION_REMOVE;
+  const Selection_operation revert = (tui_st.visual_mode == VISUAL_SELECT) ? SELECTION_REMOVE : SELECTION_ADD;
+  const unsigned int from = tui_st.current_pos;
+  const unsigned int start = tui_st.visual_start_pos;
+
+  // Same result as moving one position at a time: the positions left behind
+  // on the way to the start are reverted, and the ones reached past the
+  // start get the visual operation
+  if (pos > from) {
+    if (from < start) update_selection_range(from, ((pos < start) ? pos : start) - 1, revert);
+    update_selection_range(((from > start) ? from : start) + 1, pos, apply);
+  } else if (pos < from) {
+    update_selection_range(((pos > start) ? pos : start) + 1, from, revert);
+    if (pos < start) update_selection_range(pos, ((from < start) ? from : start) - 1, apply);
+  }
 
-  const bool is_opposing_the_flow = (direction == 1)
-                                    ? tui_st.current_pos < tui_st.visual_start_pos
-                                    : tui_st.current_pos > tui_st.visual_start_pos;
-  if (is_opposing_the_flow) {
-    switch (tui_st.visual_mode) {
-      case VISUAL_SELECT:   unselect_current_item(); break;
-      case VISUAL_UNSELECT: select_current_item();   break;
+  tui_st.current_pos = pos;
+}
+
+void find_todo() {
+  if (list_is_empty(todo_list)) return;
+
+  const char *prompt = "/";
+  const char *cursor = "--> ";
+  const unsigned int cursor_length = strlen(cursor);
+  const unsigned int results_start_y = 2;
+  const unsigned int max_results = (window_size.height > results_start_y) ? window_size.height - results_start_y : 1;
+
+  Fuzzy_match *matches = malloc(max_results * sizeof(Fuzzy_match));
+  if (!matches) abort();
+
+  // The list doesn't change while finding, so the index is built only once
+  Fuzzy_index index;
+  todo_list_fuzzy_index_init(&index);
+
+  char pattern[INPUT_SIZE] = "";
+  unsigned int pattern_length = 0;
+  unsigned int found = 0, shown = 0, selected = 0;
+  bool outdated = true;
+
+  curs_set(1);
+  bool read = true;
+  while (read) {
+    if (outdated) {
+      found = fuzzy_search(&index, pattern, matches, max_results);
+      shown = (found < max_results) ? found : max_results;
+      selected = 0;
+      outdated = false;
     }
 
-    if (direction == 1) next_position();
-    else previous_position();
-  } else {
-    if (direction == 1) next_position();
-    else previous_position();
+    tui_erase();
+    for (unsigned int i = 0; i < shown; i++) {
+      if (i == selected) tui_mvprintw(results_start_y + i, area_start.x, "%s", cursor);
+      tui_mvprintw(results_start_y + i, area_start.x + cursor_length, "%u) %s", matches[i].index + 1, index.names[matches[i].index]);
+    }
 
-    switch (tui_st.visual_mode) {
-      case VISUAL_SELECT:   select_current_item();   break;
-      case VISUAL_UNSELECT: unselect_current_item(); break;
+    char counter[32];
+    snprintf(counter, sizeof(counter), "%u/%u", found, index.count);
+    tui_mvprintw(area_start.y, area_start.x + area_size.width - strlen(counter), "%s", counter);
+    tui_mvprintw(area_start.y, area_start.x + cursor_length, "%s%s", prompt, pattern);
+
+    const char c = tui_getch();
+    switch (c) {
+      case ESCAPE_KEY:
+        read = false;
+        break;
+
+      case ENTER_KEY:
+        if (shown) tui_st.current_pos = matches[selected].index;
+        read = false;
+        break;
+
+      case FIND_NEXT_KEY:
+        if (selected+1 < shown) selected++;
+        break;
+
+      case FIND_PREVIOUS_KEY:
+        if (selected > 0) selected--;
+        break;
+
+      case BACKSPACE_KEY:
+        if (pattern_length > 0) {
+          pattern[--pattern_length] = '\0';
+          outdated = true;
+        }
+        break;
+
+      default:
+        if (isprint(c) && pattern_length < INPUT_SIZE-1) {
+          pattern[pattern_length++] = c;
+          pattern[pattern_length] = '\0';
+          outdated = true;
+        }
+        break;
     }
   }
+  curs_set(0);
+
+  todo_list_fuzzy_index_free(&index);
+  free(matches);
 }
 
 Help_result show_functionality_message(const char *source, const unsigned source_index, const unsigned int source_count, const Functionality *functionality, const unsigned int functionality_count, bool are_commands, bool from_the_end, unsigned int *max_functionality_per_page) {
@@ -821,12 +1206,13 @@ bool action_save_and_quit(Input *input) {
 bool action_save(Input *input) {
   ACTION_NO_ARGS("save", input);
 
-  if (!save_todo_list(todo_list, idea_state.todos_filepath)) {
+  // The file is written by another thread, the errors are reported when it
+  // finishes
+  if (!todo_list_save_start(idea_state.todos_filepath)) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to save the ToDo list");
     return false;
   }
 
-  todo_list_modified = false;
   return true;
 }
 
@@ -883,35 +1269,66 @@ void clean_map() {
 }
 
 void parse_normal() {
-  char c = getch();
+  // Wake up periodically while a save is running or the attributes are being
+  // built to update their indicators, and once more after they end
+  const bool saving = todo_list_save_in_progress();
+  const bool building = todo_list_attributes_in_progress();
+  timeout((saving || building || tui_st.drawn_in_background) ? TUI_BACKGROUND_POLL_MS : -1);
+  const int key = tui_getch();
+  timeout(-1);
+  if (key == ERR) return;
+
+  char c = key;
 
   if (isdigit(c)) {
     add_to_command_multiplier(c-'0');
   } else if (c == ESCAPE_KEY) {
     clean_map();
   } else {
-    append_to_map_buffer(c);
-
-    for (unsigned int i=0; i<nv_maps_count; i++) {
-      if (!strcmp(tui_st.map_buffer, nv_maps[i].keys)) {
-        nv_maps[i].action();
-        clean_map();
-        break;
-      }
+    const Normal_visual_map *map = nv_map_push_key(c);
+    if (map) {
+      map->action((tui_st.command_multiplier) ? tui_st.command_multiplier : 1);
+      clean_map();
     }
   }
 }
 
 void update_area_x_axis() {
+  if (tui_st.show_notes_preview) {
+    // The preview takes the right half
+    area_size.width = window_size.width*3/8;
+    area_start.x = window_size.width/8;
+    return;
+  }
   area_size.width = window_size.width/2;
   area_start.x = (window_size.width-area_size.width)/2;
 }
 
 void update_area_y_axis() {
-  area_size.height = list_size(todo_list) + 2; // + 2 for the status line
+  const unsigned int list_height = list_size(todo_list) + STATUS_LINE_HEIGHT;
+  area_size.height = (list_height < window_size.height) ? list_height : window_size.height;
   area_start.y = (window_size.height-area_size.height)/2;
 }
 
+unsigned int visible_rows() {
+  return area_size.height - STATUS_LINE_HEIGHT;
+}
+
+void update_viewport() {
+  const unsigned int rows = visible_rows();
+  const unsigned int size = list_size(todo_list);
+
+  // The list could have shrunk or the window grown
+  if (size <= rows) tui_st.first_visible_pos = 0;
+  else if (tui_st.first_visible_pos > size - rows) tui_st.first_visible_pos = size - rows;
+
+  if (tui_st.current_pos < tui_st.first_visible_pos) {
+    tui_st.first_visible_pos = tui_st.current_pos;
+  } else if (rows && tui_st.current_pos >= tui_st.first_visible_pos + rows) {
+    tui_st.first_visible_pos = tui_st.current_pos - rows + 1;
+  }
+}
+
 void tui_print_backtrace() {
   if (list_is_empty(backtrace)) return;
   char *title = NULL;
@@ -941,12 +1358,20 @@ void tui_print_backtrace() {
   sb_free(&sb);
 }
 
-#define GET_MINIMUM_HEIGHT() list_size(todo_list) + 2
 bool window_app(void) {
   WINDOW *win = initscr();
   curs_set(0);
 
-  Size minimum_window_size = { .width = 35, .height = GET_MINIMUM_HEIGHT() };
+  const Size minimum_window_size = { .width = 35, .height = MINIMUM_WINDOW_HEIGHT };
+
+  // The ToDos shared with the background save are copied when they're modified
+  todo_list_copied = replace_selected_todo;
+  // And the ones removed by the commands leave the selection
+  todo_list_released = _unselect_released_todo;
+
+  // The list is shown while the attributes are built
+  todo_list_attributes_start();
+  tui_profiler_init();
 
   Size old_dimension = {0};
   unsigned int old_todo_list_size = -1; // '-1' makes it update the first start
@@ -955,14 +1380,14 @@ bool window_app(void) {
     window_size.height = getmaxy(win);
 
     if (window_size.width < minimum_window_size.width) {
-      erase();
-      printw("Window is not width enough...");
-      char c = getch(); // This captures when the screen resize too
+      tui_erase();
+      tui_printw("Window is not width enough...");
+      char c = tui_getch(); // This captures when the screen resize too
       if (c == 'q') tui_st.exit_loop = true;
     } else if (window_size.height < minimum_window_size.height) {
-      erase();
-      printw("Window is not height enough...");
-      char c = getch(); // This captures when the screen resize too
+      tui_erase();
+      tui_printw("Window is not height enough...");
+      char c = tui_getch(); // This captures when the screen resize too
       if (c == 'q') tui_st.exit_loop = true;
 
     } else {
@@ -971,29 +1396,43 @@ bool window_app(void) {
         update_area_x_axis();
       }
 
-      if (old_dimension.height != window_size.height) {
+      if (old_dimension.height != window_size.height || old_todo_list_size != list_size(todo_list)) {
         old_dimension.height = window_size.height;
-        update_area_y_axis();
-      }
-
-      if (old_todo_list_size != list_size(todo_list)) {
         old_todo_list_size = list_size(todo_list);
-        minimum_window_size.height = GET_MINIMUM_HEIGHT();
         update_area_y_axis();
       }
 
-      erase();
-
+      tui_profiler_phase_start(TUI_PROFILER_DRAW);
+      tui_erase();
       draw_window();
+      tui_profiler_phase_end(TUI_PROFILER_DRAW);
+      if (tui_st.show_profiler && window_size.height >= TUI_PROFILER_OVERLAY_HEIGHT) {
+        draw_tui_profiler(window_size.height - TUI_PROFILER_OVERLAY_HEIGHT, 0);
+      }
 
+      tui_profiler_phase_start(TUI_PROFILER_INPUT);
       if (tui_st.mode == MODE_COMMAND) {
         if (!parse_command()) return false;
       } else {
         parse_normal();
       }
+      tui_profiler_phase_end(TUI_PROFILER_INPUT);
+
+      tui_profiler_phase_start(TUI_PROFILER_BACKTRACE);
       tui_print_backtrace();
+      tui_profiler_phase_end(TUI_PROFILER_BACKTRACE);
+      tui_profiler_frame_end();
     }
   } while ( !tui_st.exit_loop );
 
+  todo_list_attributes_cancel();
+  todo_list_save_wait();
+  tui_print_backtrace();
+  todo_list_copied = NULL;
+  todo_list_released = NULL;
+  pointer_set_free(&tui_st.selected);
+  free_notes_preview_cache();
+  tui_profiler_free();
+  tui_free_maps_tries();
   return (endwin() != ERR);
 }
@@ -4,10 +4,15 @@
 #include <ncurses.h>
 
 #include "../../../utils/list.h"
+#include "../../../utils/pointer_set.h"
+#include "../../../utils/string.h"
 #include "../../todos/todo_list.h"
 #include "tui_mappings.h"
 
 #define INPUT_SIZE 128
+#define STATUS_LINE_HEIGHT 2
+#define MINIMUM_WINDOW_HEIGHT (STATUS_LINE_HEIGHT + 1) // At least one ToDo is visible
+#define TUI_BACKGROUND_POLL_MS 100
 
 typedef struct {
   unsigned int width;
@@ -27,9 +32,10 @@ typedef struct {
     MODE_COMMAND,
   } mode;
 
-  List selected;
+  Pointer_set selected; // Todo *, in the order they were selected
 
   unsigned int current_pos;
+  unsigned int first_visible_pos; // The list scrolls when it's taller than the window
 
   unsigned int command_multiplier;
 
@@ -51,6 +57,13 @@ typedef struct {
 
   char map_buffer[MAP_BUFFER_SIZE];
 
+  bool show_notes_preview; // The list moves to the left to make room for it
+  bool show_profiler; // Overlay with the frame times (see tui_profiler.h)
+
+  // A save or the attributes were in progress when the window was drawn, so
+  // it has to be drawn again even if they end before the next key
+  bool drawn_in_background;
+
 } Tui_state;
 extern Tui_state tui_st;
 
@@ -66,16 +79,31 @@ typedef enum {
   HELP_RETURN_QUIT,
 } Help_result;
 
+// Lines shown by the pager. `next` appends the next line (without the new
+// line character) and returns false when there are no more
+typedef struct {
+  bool (*next)(void *state, String_builder *line);
+  void *state;
+} Pager_iterator;
+
 // Window drawing
 void draw_rect(int y1, int x1, int y2, int x2);
-char message(char *title, char *msg);
+char message(char *title, char *msg); // Shown in a pager if it doesn't fit in the window
+// Scrollable message box that only reads the lines it shows. Returns the key
+// that closed it
+int pager(char *title, Pager_iterator iterator);
+Pager_iterator pager_string_iterator(const char **cursor); // Lines of the string, it advances the cursor
 bool confirm(char *msg, Confirm_type type);
 void draw_window(void);
+void draw_indicators(Todo *todo, unsigned int y);
 bool window_app(void);
 void tui_print_backtrace();
 
 void update_area_x_axis();
 void update_area_y_axis();
+unsigned int visible_rows();
+// Scrolls the minimum to keep the cursor visible
+void update_viewport();
 
 void append_to_map_buffer(char c);
 void clean_map();
@@ -103,16 +131,38 @@ bool action_add_at_todo_tui(Input *input);
 extern Functionality tui_functionality[];
 extern unsigned int tui_functionality_count;
 
+// Makes the commands of another module available in the command mode. The
+// built-in commands keep the priority if the names collide
+bool tui_register_functionality(Functionality functionality[], unsigned int functionality_count);
+
 // Normal-Visual mode
+typedef enum {
+  SELECTION_ADD,
+  SELECTION_REMOVE,
+  SELECTION_TOGGLE,
+} Selection_operation;
+
+// The selection follows a ToDo that is replaced (NULL if it's removed)
+void replace_selected_todo(Todo *old, Todo *new);
 bool is_current_item_selected();
 bool select_current_item();
 bool unselect_current_item();
 void toggle_select_item();
+// Applies the operation to the ToDos between the positions (both included)
+void update_selection_range(unsigned int first, unsigned int last, Selection_operation operation);
 bool next_position();
 bool previous_position();
-bool move_selected(int direction);
+void move_cursor(int offset); // Clamped to the list
+// Moves the selected ToDos up (negative) or down (positive) as if they were
+// moved one position at a time. Returns how many positions they moved
+unsigned int move_selected(int positions);
 bool delete_selected();
-void visual_move_cursor(int direction);
+// Moves the cursor in visual mode, updating the selection of the ToDos in
+// between
+void visual_move_cursor_to(unsigned int pos);
+// Incremental fuzzy finder of the ToDo names. Ctrl-N and Ctrl-P choose a
+// match and Enter moves the cursor to it
+void find_todo();
 void parse_normal();
 void populate_command_input(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
 
@@ -1,11 +1,14 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include "tui_mappings.h"
 #include "tui.h"
+#include "tui_profiler.h"
 #include "../../main.h"
 #include "../../todos/notes_parser.h"
 #include "../../utils/backtrace.h"
 #include "../../../utils/string.h"
+#include "../../../utils/trie.h"
 
 #define UNUSED(var) (void) var;
 
@@ -28,12 +31,12 @@ void c_map_left(int *input_cursor, int *input_length, int screen_y, int *screen_
   UNUSED(input_length);
 
   if (!*input_cursor) return;
-  move(screen_y, --(*screen_x)); (*input_cursor)--;
+  tui_move(screen_y, --(*screen_x)); (*input_cursor)--;
 }
 
 void c_map_right(int *input_cursor, int *input_length, int screen_y, int *screen_x) {
   if (*input_cursor >= *input_length) return;
-  move(screen_y, ++(*screen_x));
+  tui_move(screen_y, ++(*screen_x));
   (*input_cursor)++;
 }
 
@@ -59,7 +62,7 @@ void c_map_insert(int *input_cursor, int *input_length, int screen_y, int *scree
 void c_map_append(int *input_cursor, int *input_length, int screen_y, int *screen_x) {
   if (*input_cursor == *input_length) return;
   (*input_cursor)++;
-  move(screen_y, ++(*screen_x));
+  tui_move(screen_y, ++(*screen_x));
   tui_st.command_input_mode = COMMAND_INPUT_INSERT;
 }
 
@@ -71,7 +74,7 @@ void c_map_backward_word(int *input_cursor, int *input_length, int screen_y, int
   if (command_input_move_to_previous_character(input_cursor, STRINGIFY(' '))) (*input_cursor)++;
   unsigned int delta = start - *input_cursor;
   (*screen_x) -= delta;
-  move(screen_y, *screen_x);
+  tui_move(screen_y, *screen_x);
 }
 
 void c_map_forward_word(int *input_cursor, int *input_length, int screen_y, int *screen_x) {
@@ -79,7 +82,7 @@ void c_map_forward_word(int *input_cursor, int *input_length, int screen_y, int
   if (command_input_move_to_next_character(input_cursor, *input_length, STRINGIFY(' '))) (*input_cursor)++;
   unsigned int delta = *input_cursor - start;
   *screen_x += delta;
-  move(screen_y, *screen_x);
+  tui_move(screen_y, *screen_x);
 }
 
 void c_map_forward_word_end(int *input_cursor, int *input_length, int screen_y, int *screen_x) {
@@ -93,20 +96,20 @@ void c_map_forward_word_end(int *input_cursor, int *input_length, int screen_y,
   }
   unsigned int delta = *input_cursor - start;
   *screen_x += delta;
-  move(screen_y, *screen_x);
+  tui_move(screen_y, *screen_x);
 }
 
 void c_map_start(int *input_cursor, int *input_length, int screen_y, int *screen_x) {
   UNUSED(input_length);
 
   *screen_x -= *input_cursor;
-  move(screen_y, *screen_x);
+  tui_move(screen_y, *screen_x);
   *input_cursor = 0;
 }
 
 void c_map_end(int *input_cursor, int *input_length, int screen_y, int *screen_x) {
   *screen_x += *input_length - *input_cursor;
-  move(screen_y, *screen_x);
+  tui_move(screen_y, *screen_x);
   *input_cursor = *input_length;
 }
 
@@ -143,18 +146,18 @@ void c_map_remove_char(int *input_cursor, int *input_length, int screen_y, int *
 
   for (int z = *input_cursor; z < *input_length; z++) {
     tui_st.input[z] = tui_st.input[z+1];
-    addch((z == *input_length-1) ? ' ' : tui_st.input[z]);
+    tui_addch((z == *input_length-1) ? ' ' : tui_st.input[z]);
   }
   (*input_length)--;
   if (*input_cursor == *input_length && *input_cursor != 0) {
     (*input_cursor)--;
     (*screen_x)--;
   }
-  move(screen_y, *screen_x);
+  tui_move(screen_y, *screen_x);
 }
 
 char get_character_to_jump(int *input_cursor, int *input_length, int screen_y, int *screen_x) {
-  char c = getch();
+  char c = tui_getch();
   (*screen_x)++;
 
   // Backspace and Escape keys when pressed they print 2 characters
@@ -185,7 +188,7 @@ void jump_to_char(Jump_to_char jump, int *input_cursor, int *input_length, int s
 
   unsigned int delta = new_cursor - *input_cursor;
   *screen_x += delta;
-  move(screen_y, *screen_x);
+  tui_move(screen_y, *screen_x);
   *input_cursor = new_cursor;
 }
 
@@ -258,94 +261,90 @@ unsigned int c_maps_count = sizeof(c_maps) / sizeof(Command_map);
 ////////////////// Normal-Visual MAPS //////////////////
 ////////////////////////////////////////////////////////
 
-#define APPLY_MULTIPLIER(command) do {                                                                \
-  if (tui_st.command_multiplier == 0) {                                                               \
-    command;                                                                                          \
-  } else {                                                                                            \
-    for (unsigned int _i=0; _i<tui_st.command_multiplier && _i < list_size(todo_list); _i++) command; \
-  }                                                                                                   \
-} while (0)
-
-void nv_map_toggle() {
-  APPLY_MULTIPLIER({
-    toggle_select_item();
-    next_position();
-  });
-}
-
-void nv_map_cursor_down() {
-  APPLY_MULTIPLIER({
-    switch (tui_st.mode) {
-      case MODE_NORMAL:  next_position();       break;
-      case MODE_VISUAL:  visual_move_cursor(1); break;
-      case MODE_COMMAND: break; /* unreachable */
-    }
-  });
+// The mappings receive the count typed before them (1 if there isn't one) and
+// apply it at once, instead of repeating a single step
+
+void nv_map_toggle(unsigned int count) {
+  if (list_is_empty(todo_list)) return;
+
+  const unsigned int last = (count < list_size(todo_list) - tui_st.current_pos) ? tui_st.current_pos + count - 1 : list_size(todo_list) - 1;
+  update_selection_range(tui_st.current_pos, last, SELECTION_TOGGLE);
+  move_cursor(count);
 }
 
-void nv_map_cursor_up() {
-  APPLY_MULTIPLIER({
-    switch (tui_st.mode) {
-      case MODE_NORMAL: previous_position();    break;
-      case MODE_VISUAL: visual_move_cursor(-1); break;
-      case MODE_COMMAND: break; /* unreachable */
-    }
-  });
+void nv_map_cursor_down(unsigned int count) {
+  switch (tui_st.mode) {
+    case MODE_NORMAL: move_cursor(count); break;
+    case MODE_VISUAL:
+      if (count < list_size(todo_list) - tui_st.current_pos) visual_move_cursor_to(tui_st.current_pos + count);
+      else visual_move_cursor_to(list_size(todo_list) - 1);
+      break;
+    case MODE_COMMAND: break; /* unreachable */
+  }
 }
 
-void nv_map_move_to_top() {
+void nv_map_cursor_up(unsigned int count) {
+  switch (tui_st.mode) {
+    case MODE_NORMAL: move_cursor(-(int) count); break;
+    case MODE_VISUAL: visual_move_cursor_to((count < tui_st.current_pos) ? tui_st.current_pos - count : 0); break;
+    case MODE_COMMAND: break; /* unreachable */
+  }
+}
+
+void nv_map_move_to_top(unsigned int count) {
+  UNUSED(count);
+
   switch (tui_st.mode) {
     case MODE_NORMAL:
-      // if (!list_is_empty(tui_st.selected)) {
-      //   while (move_selected(-1));
+      // if (!pointer_set_is_empty(&tui_st.selected)) {
+      //   move_selected(-list_size(todo_list));
       //   todo_list_modified = true;
       // }
-      while (previous_position());
+      tui_st.current_pos = 0;
       break;
-    case MODE_VISUAL: while (tui_st.current_pos) visual_move_cursor(-1); break;
+    case MODE_VISUAL: visual_move_cursor_to(0); break;
     case MODE_COMMAND: break; /* unreachable */
   }
 }
-void nv_map_move_to_bottom() {
+void nv_map_move_to_bottom(unsigned int count) {
+  UNUSED(count);
   if (list_is_empty(todo_list)) return;
 
   switch (tui_st.mode) {
     case MODE_NORMAL:
-      // if (!list_is_empty(tui_st.selected)) {
-      //   while (move_selected(1));
+      // if (!pointer_set_is_empty(&tui_st.selected)) {
+      //   move_selected(list_size(todo_list));
       //   todo_list_modified = true;
       // }
-      while (next_position());
+      tui_st.current_pos = list_size(todo_list) - 1;
       break;
-    case MODE_VISUAL: while (tui_st.current_pos < list_size(todo_list)-1) visual_move_cursor(1); break;
+    case MODE_VISUAL: visual_move_cursor_to(list_size(todo_list) - 1); break;
     case MODE_COMMAND: break; /* unreachable  */
   }
 }
 
-void nv_map_save() { action_save(NULL); }
-void nv_map_save_and_exit() { action_save_and_quit(NULL); }
-void nv_map_force_quit() { action_force_quit(NULL); }
-void nv_map_quit() { action_quit(NULL); }
+void nv_map_save(unsigned int count) { UNUSED(count); action_save(NULL); }
+void nv_map_save_and_exit(unsigned int count) { UNUSED(count); action_save_and_quit(NULL); }
+void nv_map_force_quit(unsigned int count) { UNUSED(count); action_force_quit(NULL); }
+void nv_map_quit(unsigned int count) { UNUSED(count); action_quit(NULL); }
 
-void nv_map_toggle_visual() {
+void nv_map_toggle_visual(unsigned int count) {
   switch (tui_st.mode) {
-    case MODE_NORMAL:
+    case MODE_NORMAL: {
+      if (list_is_empty(todo_list)) return;
+
       tui_st.visual_start_pos = tui_st.current_pos;
       tui_st.mode = MODE_VISUAL;
       tui_st.visual_mode = (is_current_item_selected())
                            ? VISUAL_UNSELECT
                            : VISUAL_SELECT;
 
-      APPLY_MULTIPLIER({
-        switch (tui_st.visual_mode) {
-          case VISUAL_SELECT:   select_current_item();   break;
-          case VISUAL_UNSELECT: unselect_current_item(); break;
-        }
-        next_position();
-      });
-
-      if (tui_st.current_pos != list_size(todo_list)-1) previous_position();
+      // The count selects (or unselects) that many ToDos from the cursor
+      const unsigned int last = (count < list_size(todo_list) - tui_st.current_pos) ? tui_st.current_pos + count - 1 : list_size(todo_list) - 1;
+      update_selection_range(tui_st.current_pos, last, (tui_st.visual_mode == VISUAL_SELECT) ? SELECTION_ADD : SELECTION_REMOVE);
+      tui_st.current_pos = last;
       break;
+    }
 
     case MODE_VISUAL:
       tui_st.mode = MODE_NORMAL;
@@ -355,64 +354,70 @@ void nv_map_toggle_visual() {
   }
 }
 
-void nv_map_move_down() {
-  APPLY_MULTIPLIER({
-      if (move_selected(1)) {
-        next_position();
-        if (tui_st.mode == MODE_VISUAL) tui_st.visual_start_pos++;
-        todo_list_modified = true;
-      }
-  });
+void nv_map_move_down(unsigned int count) {
+  const unsigned int moved = move_selected(count);
+  if (!moved) return;
+
+  move_cursor(moved);
+  if (tui_st.mode == MODE_VISUAL) tui_st.visual_start_pos += moved;
+  todo_list_modified = true;
 }
 
-void nv_map_move_up() {
-  APPLY_MULTIPLIER({
-      if (move_selected(-1)) {
-        previous_position();
-        if (tui_st.mode == MODE_VISUAL) tui_st.visual_start_pos--;
-        todo_list_modified = true;
-      }
-  });
+void nv_map_move_up(unsigned int count) {
+  const unsigned int moved = move_selected(-(int) count);
+  if (!moved) return;
+
+  move_cursor(-(int) moved);
+  if (tui_st.mode == MODE_VISUAL) tui_st.visual_start_pos = (moved < tui_st.visual_start_pos) ? tui_st.visual_start_pos - moved : 0;
+  todo_list_modified = true;
 }
-void nv_map_unselect() {
-  if (tui_st.mode == MODE_NORMAL) list_destroy(&tui_st.selected, NULL);
+void nv_map_unselect(unsigned int count) {
+  UNUSED(count);
+  if (tui_st.mode == MODE_NORMAL) pointer_set_clear(&tui_st.selected);
 }
 
-void nv_map_command() {
+void nv_map_command(unsigned int count) {
+  UNUSED(count);
   if (tui_st.mode == MODE_NORMAL) tui_st.mode = MODE_COMMAND;
   curs_set(1);
   tui_st.command_input_mode = COMMAND_INPUT_INSERT;
 }
 
-void nv_map_delete() {
+void nv_map_delete(unsigned int count) {
+  UNUSED(count);
   if (tui_st.mode == MODE_NORMAL) {
-    /* if (list_is_empty(tui_st.selected)) select_current_item(); */
+    /* if (pointer_set_is_empty(&tui_st.selected)) select_current_item(); */
 
     if (delete_selected()) todo_list_modified = true;
   }
 }
 
-void nv_map_add_below_cursor() {
+void nv_map_add_below_cursor(unsigned int count) {
+  UNUSED(count);
   unsigned int pos = (list_is_empty(todo_list)) ? 1 : tui_st.current_pos + 1 /* 0-based to 1-based) */ + 1 /* next pos */;
   populate_command_input("add_at %d ", pos);
 }
 
-void nv_map_add_above_cursor() {
+void nv_map_add_above_cursor(unsigned int count) {
+  UNUSED(count);
   populate_command_input("add_at %d ", tui_st.current_pos + 1 /* 0-based to 1-based) */);
 }
 
-void nv_map_edit() {
+void nv_map_edit(unsigned int count) {
+  UNUSED(count);
   const char *todo_name = ((Todo *)list_get(todo_list, tui_st.current_pos))->name;
   populate_command_input("edit %d %s", tui_st.current_pos + 1 /* 0-based to 1-based) */, todo_name);
 }
 
-void nv_map_export_html() {
+void nv_map_export_html(unsigned int count) {
+  UNUSED(count);
   String_builder sb = sb_create("html ");
   const unsigned int html_filename_index = sb.length;
 
-  List_iterator iterator = list_iterator_create(tui_st.selected);
-  while (list_iterator_next(&iterator)) {
-    const Todo *t = list_iterator_element(iterator);
+  // The command input can't hold more positions, so the rest aren't searched
+  Pointer_set_iterator iterator = pointer_set_iterator_create(&tui_st.selected);
+  while (sb.length < INPUT_SIZE && pointer_set_iterator_next(&iterator)) {
+    const Todo *t = pointer_set_iterator_element(iterator);
     const int index = list_get_index_of(todo_list, t);
     if (index == -1) abort();
     sb_append_with_format(&sb, " %d", index + 1 /* 0-based to 1-based */);
@@ -423,89 +428,135 @@ void nv_map_export_html() {
   sb_free(&sb);
 }
 
-void nv_map_reload() {
-  if (!todo_list_modified) return;
+// The cursor follows its ToDo when the list is reloaded
+Todo *reload_cursor_todo = NULL;
 
-  bool ok = confirm("Discard the changes and reload the ToDo list?", CONFIRM_DEFAULT_NO);
-  if (!ok) return;
+void _reload_replaced(Todo *old, Todo *new) {
+  if (old == reload_cursor_todo) reload_cursor_todo = new;
+  replace_selected_todo(old, new);
+}
+
+void nv_map_reload(unsigned int count) {
+  UNUSED(count);
+  if (todo_list_modified) {
+    bool ok = confirm("Discard the changes and reload the ToDo list?", CONFIRM_DEFAULT_NO);
+    if (!ok) return;
+  }
 
-  if (!load_todo_list(&todo_list, idea_state.todos_filepath, true)) {
+  todo_list_save_wait(); // Don't read a half written file
+  reload_cursor_todo = (list_is_empty(todo_list)) ? NULL : list_get(todo_list, tui_st.current_pos);
+  if (!reload_todo_list(idea_state.todos_filepath, _reload_replaced)) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to reload the ToDo list!");
     return;
   }
 
+  // If its ToDo was removed, the cursor stays in the same position
+  const unsigned int size = list_size(todo_list);
+  if (reload_cursor_todo) tui_st.current_pos = list_get_index_of(todo_list, reload_cursor_todo);
+  else if (tui_st.current_pos >= size) tui_st.current_pos = (size) ? size-1 : 0;
+  reload_cursor_todo = NULL;
+
   todo_list_modified = false;
+  todo_list_attributes_start();
+}
+
+void nv_map_find(unsigned int count) {
+  UNUSED(count);
+  if (tui_st.mode == MODE_NORMAL) find_todo();
+}
+
+void nv_map_toggle_notes_preview(unsigned int count) {
+  UNUSED(count);
+  tui_st.show_notes_preview = !tui_st.show_notes_preview;
+  update_area_x_axis();
+}
+
+void nv_map_toggle_profiler(unsigned int count) {
+  UNUSED(count);
+  tui_st.show_profiler = !tui_st.show_profiler;
+}
+
+// Section of the information of a ToDo: a header and a line per element of
+// the list, formatted when the pager shows it
+typedef struct {
+  char *header;
+  List_iterator iterator;
+  bool header_shown;
+  void (*format)(const void *element, String_builder *line);
+} Todo_information_section;
+
+bool _todo_information_next(void *state, String_builder *line) {
+  Todo_information_section *section = state;
+  if (!section->header_shown) {
+    section->header_shown = true;
+    sb_append(line, section->header);
+    return true;
+  }
+
+  if (!list_iterator_next(&section->iterator)) return false;
+  section->format(list_iterator_element(section->iterator), line);
+  return true;
+}
+
+// Returns the key that closed the pager
+int _show_todo_information_section(char *title, char *header, List elements, void (*format)(const void *element, String_builder *line)) {
+  Todo_information_section section = {
+    .header = header,
+    .iterator = list_iterator_create(elements),
+    .format = format,
+  };
+  return pager(title, (Pager_iterator) { .next = _todo_information_next, .state = &section });
 }
 
-void nv_map_todo_information() {
+void _format_tag(const void *element, String_builder *line) {
+  sb_append_with_format(line, "  - %s", (const char *) element);
+}
+
+void _format_task(const void *element, String_builder *line) {
+  const unsigned int tasks_level_indentation = 4;
+  const Task *t = element;
+  for (unsigned int x = 0; x < t->level * tasks_level_indentation; x++) sb_append_char(line, ' ');
+  sb_append_with_format(line, "  - [%c] %s", t->state, t->msg);
+}
+
+void _format_reminder(const void *element, String_builder *line) {
+  const Reminder *rem = element;
+  sb_append_with_format(line, "  - %04d/%02d/%02d", rem->start.year, rem->start.month, rem->start.day);
+  if (!is_date_equals(rem->start, rem->end)) {
+    sb_append_with_format(line, " ~ %04d/%02d/%02d", rem->end.year, rem->end.month, rem->end.day);
+  }
+  sb_append_with_format(line, ": %s (from %s)", rem->name, rem->todo->name);
+}
+
+void nv_map_todo_information(unsigned int count) {
+  UNUSED(count);
   Todo *todo = list_get(todo_list, tui_st.current_pos);
-  String_builder sb = sb_new();
 
-  if (!build_attributes(todo)) {
+  if (todo->attributes_pending) todo_list_attributes_wait();
+  if (!todo->attributes.generated && !build_attributes(todo)) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to load the attributes from the notes");
     return;
   }
 
   // Tags
   if (!list_is_empty(todo->attributes.tags)) {
-    sb_append(&sb, "Tags:\n");
-    List_iterator tag_iterator = list_iterator_create(todo->attributes.tags);
-    while (list_iterator_next(&tag_iterator)) {
-      const char *tag = list_iterator_element(tag_iterator);
-
-      sb_append_with_format(&sb, "  - %s\n", tag);
-    }
-
-    sb_append(&sb, "\n");
-    sb_append(&sb, "\nPress a key to continue...");
-    if (message("ToDo Tags", sb.str) == 'q') {
-      sb_free(&sb);
-      return;
-    }
-    sb_clean(&sb);
+    if (_show_todo_information_section("ToDo Tags", "Tags:", todo->attributes.tags, _format_tag) == 'q') return;
   }
 
   // Tasks
   if (!list_is_empty(todo->attributes.tasks)) {
-    const unsigned int tasks_level_indentation = 4;
-    sb_append(&sb, "Tasks:\n");
-    List_iterator iterator = list_iterator_create(todo->attributes.tasks);
-    while (list_iterator_next(&iterator)) {
-      const Task *t = list_iterator_element(iterator);
-      for (unsigned int x = 0; x < t->level * tasks_level_indentation; x++) sb_append_char(&sb, ' ');
-      sb_append_with_format(&sb, "  - [%c] %s\n", t->state, t->msg);
-    }
-    sb_append(&sb, "\nPress a key to continue...");
-    if (message("ToDo Tasks", sb.str) == 'q') {
-      sb_free(&sb);
-      return;
-    }
-    sb_clean(&sb);
+    const Task_counters counters = todo->attributes.task_counters;
+    String_builder header = sb_new();
+    sb_append_with_format(&header, "Tasks: %u/%u done (%u%%)", counters.done, counters.total - counters.removed, task_counters_progress(counters));
+    const int key = _show_todo_information_section("ToDo Tasks", header.str, todo->attributes.tasks, _format_task);
+    sb_free(&header);
+    if (key == 'q') return;
   }
 
   // Reminders
   if (!list_is_empty(todo->attributes.reminders)) {
-    sb_append(&sb, "Reminders:\n");
-    List_iterator rem_iterator = list_iterator_create(todo->attributes.reminders);
-    while (list_iterator_next(&rem_iterator)) {
-      const Reminder *rem = list_iterator_element(rem_iterator);
-
-      sb_append_with_format(&sb, "  - %04d/%02d/%02d", rem->start.year, rem->start.month, rem->start.day);
-      if (!is_date_equals(rem->start, rem->end)) {
-        sb_append_with_format(&sb, " ~ %04d/%02d/%02d", rem->end.year, rem->end.month, rem->end.day);
-      }
-      sb_append_with_format(&sb, ": %s (from %s)\n", rem->name, rem->todo->name);
-
-    }
-    sb_append(&sb, "\nPress a key to continue...");
-    if (message("ToDo Reminders", sb.str) == 'q') {
-      sb_free(&sb);
-      return;
-    }
-    sb_clean(&sb);
+    if (_show_todo_information_section("ToDo Reminders", "Reminders:", todo->attributes.reminders, _format_reminder) == 'q') return;
   }
-
-  sb_free(&sb);
 }
 
 Normal_visual_map nv_maps[] = {
@@ -528,8 +579,78 @@ Normal_visual_map nv_maps[] = {
   { "O"                   , "Create a new ToDo above the cursor"                  , nv_map_add_above_cursor },
   { "a"                   , "Change the name of the current ToDo"                 , nv_map_edit },
   { "e"                   , "Export the selected ToDos to HTML"                   , nv_map_export_html },
-  { "r"                   , "Discard all the changes and reload the ToDo list"    , nv_map_reload },
+  { "r"                   , "Reload the ToDo list (discarding the changes)"       , nv_map_reload },
   { "i"                   , "Show the information about the ToDo"                 , nv_map_todo_information },
+  { "/"                   , "Fuzzy find a ToDo by its name and jump to it"        , nv_map_find },
+  { "p"                   , "Show or hide the notes of the ToDo next to the list" , nv_map_toggle_notes_preview },
+  { "F"                   , "Show or hide the frame times of the TUI"             , nv_map_toggle_profiler },
 };
 
 unsigned int nv_maps_count = sizeof(nv_maps) / sizeof(Normal_visual_map);
+
+//////////////////////////////////////////////////////
+/////////////////////// DISPATCH /////////////////////
+//////////////////////////////////////////////////////
+// The mappings are looked up in prefix tries, so a key costs the same
+// whatever the number of mappings
+Trie c_maps_trie = {0};
+Trie nv_maps_trie = {0};
+bool maps_tries_ready = false;
+
+bool _register_map(Trie *trie, const char *keys, const void *map) {
+  // The keys that are being typed must fit in the map buffer
+  if (strlen(keys) >= MAP_BUFFER_SIZE || !trie_insert(trie, keys, map)) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Invalid keys for a mapping: '%s'", keys);
+    return false;
+  }
+  return true;
+}
+
+void _maps_tries_init() {
+  if (maps_tries_ready) return;
+  maps_tries_ready = true;
+
+  for (unsigned int i = 0; i < c_maps_count; i++) if (!_register_map(&c_maps_trie, c_maps[i].keys, &c_maps[i])) abort();
+  for (unsigned int i = 0; i < nv_maps_count; i++) if (!_register_map(&nv_maps_trie, nv_maps[i].keys, &nv_maps[i])) abort();
+}
+
+void tui_free_maps_tries() {
+  trie_free(&c_maps_trie);
+  trie_free(&nv_maps_trie);
+  maps_tries_ready = false;
+}
+
+bool tui_register_c_maps(Command_map maps[], unsigned int maps_count) {
+  _maps_tries_init();
+  for (unsigned int i = 0; i < maps_count; i++) if (!_register_map(&c_maps_trie, maps[i].keys, &maps[i])) return false;
+  return true;
+}
+
+bool tui_register_nv_maps(Normal_visual_map maps[], unsigned int maps_count) {
+  _maps_tries_init();
+  for (unsigned int i = 0; i < maps_count; i++) if (!_register_map(&nv_maps_trie, maps[i].keys, &maps[i])) return false;
+  return true;
+}
+
+void *_map_buffer_push(const Trie *trie, char c) {
+  append_to_map_buffer(c);
+  const Trie_node *node = trie_find_prefix(trie, tui_st.map_buffer);
+  if (!node) {
+    // No mapping continues with the key, so it can only start a new one
+    tui_st.map_buffer[0] = '\0';
+    append_to_map_buffer(c);
+    node = trie_find_prefix(trie, tui_st.map_buffer);
+    if (!node) tui_st.map_buffer[0] = '\0';
+  }
+  return trie_node_value(node);
+}
+
+const Command_map *c_map_push_key(char c) {
+  _maps_tries_init();
+  return _map_buffer_push(&c_maps_trie, c);
+}
+
+const Normal_visual_map *nv_map_push_key(char c) {
+  _maps_tries_init();
+  return _map_buffer_push(&nv_maps_trie, c);
+}
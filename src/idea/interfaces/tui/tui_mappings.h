@@ -7,6 +7,8 @@
 #define ESCAPE_KEY 27
 #define BACKSPACE_KEY 127
 #define ENTER_KEY 10
+#define FIND_NEXT_KEY 14 // Ctrl-N
+#define FIND_PREVIOUS_KEY 16 // Ctrl-P
 
 #define STRINGIFY(...) (char[]){__VA_ARGS__, '\0'}
 
@@ -60,32 +62,53 @@ extern unsigned int c_maps_count;
 typedef struct {
   char *keys;
   char *description;
-  void (*action)();
+  void (*action)(unsigned int count); // 1 if no count was typed
 } Normal_visual_map;
 
-void nv_map_toggle();
-void nv_map_cursor_down();
-void nv_map_cursor_up();
-void nv_map_move_to_top();
-void nv_map_move_to_bottom();
-void nv_map_save();
-void nv_map_save_and_exit();
-void nv_map_force_quit();
-void nv_map_quit();
-void nv_map_toggle_visual();
-void nv_map_move_down();
-void nv_map_move_up();
-void nv_map_unselect();
-void nv_map_command();
-void nv_map_clear_command_multiplier();
-void nv_map_delete();
-void nv_map_add_below_cursor();
-void nv_map_add_above_cursor();
-void nv_map_edit();
-void nv_map_export_html();
-void nv_map_reload();
+void nv_map_toggle(unsigned int count);
+void nv_map_cursor_down(unsigned int count);
+void nv_map_cursor_up(unsigned int count);
+void nv_map_move_to_top(unsigned int count);
+void nv_map_move_to_bottom(unsigned int count);
+void nv_map_save(unsigned int count);
+void nv_map_save_and_exit(unsigned int count);
+void nv_map_force_quit(unsigned int count);
+void nv_map_quit(unsigned int count);
+void nv_map_toggle_visual(unsigned int count);
+void nv_map_move_down(unsigned int count);
+void nv_map_move_up(unsigned int count);
+void nv_map_unselect(unsigned int count);
+void nv_map_command(unsigned int count);
+void nv_map_delete(unsigned int count);
+void nv_map_add_below_cursor(unsigned int count);
+void nv_map_add_above_cursor(unsigned int count);
+void nv_map_edit(unsigned int count);
+void nv_map_export_html(unsigned int count);
+void nv_map_reload(unsigned int count);
+void nv_map_find(unsigned int count);
+void nv_map_toggle_notes_preview(unsigned int count);
+void nv_map_toggle_profiler(unsigned int count);
 
 extern Normal_visual_map nv_maps[];
 extern unsigned int nv_maps_count;
 
+////////////////////////////////////////////////////////
+/////////////////////// DISPATCH ///////////////////////
+////////////////////////////////////////////////////////
+
+// Register more mappings (e.g. user defined). A mapping replaces the one
+// with the same keys, and a mapping whose keys are a prefix of others is
+// triggered before those can be typed
+bool tui_register_c_maps(Command_map maps[], unsigned int maps_count);
+bool tui_register_nv_maps(Normal_visual_map maps[], unsigned int maps_count);
+// The registered mappings are lost, the built-in ones are added again when
+// a key is pushed
+void tui_free_maps_tries();
+
+// Add the key to the map buffer and return the mapping that its keys
+// complete, if any. If no mapping continues with the key, the buffer starts
+// again from it
+const Command_map *c_map_push_key(char c);
+const Normal_visual_map *nv_map_push_key(char c);
+
 #endif // MAPPINGS
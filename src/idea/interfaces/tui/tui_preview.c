@@ -0,0 +1,103 @@
+#include <ncurses.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tui_preview.h"
+#include "tui_profiler.h"
+#include "../../todos/notes_parser.h"
+#include "../../../utils/string.h"
+
+// Indexed by the hash of the notes
+Notes_preview_layout notes_preview_cache[NOTES_PREVIEW_CACHE_SIZE] = {0};
+
+int _notes_preview_line_attributes(const char *line, unsigned int length) {
+  while (length && *line == ' ') line++, length--;
+
+  if (is_a_task(line, length)) {
+    const char state = line[3]; // "- [x] "
+    return (state == 'x' || state == '~') ? A_DIM : A_BOLD;
+  }
+  if (is_property("reminder", line)) return A_UNDERLINE;
+  return A_NORMAL;
+}
+
+void _notes_preview_add_row(Notes_preview_layout *layout, unsigned int offset, unsigned int length, int attributes) {
+  if (layout->rows_count == layout->rows_capacity) {
+    layout->rows_capacity = (layout->rows_capacity) ? layout->rows_capacity*2 : 32;
+    layout->rows = realloc(layout->rows, layout->rows_capacity * sizeof(Notes_preview_row));
+    if (!layout->rows) abort();
+  }
+  layout->rows[layout->rows_count++] = (Notes_preview_row) { .offset = offset, .length = length, .attributes = attributes };
+}
+
+// Wraps the first `rows` rows of the notes
+void _notes_preview_wrap(Notes_preview_layout *layout, const char *notes, unsigned int rows) {
+  layout->rows_count = 0;
+
+  unsigned int line = 0;
+  while (line < layout->notes_length && layout->rows_count < rows) {
+    const char *end = strchr(notes + line, '\n');
+    const unsigned int line_length = (end) ? (unsigned int)(end - notes) - line : layout->notes_length - line;
+    const int attributes = _notes_preview_line_attributes(notes + line, line_length);
+
+    unsigned int wrapped = 0;
+    do {
+      const unsigned int length = (line_length - wrapped < layout->width) ? line_length - wrapped : layout->width;
+      _notes_preview_add_row(layout, line + wrapped, length, attributes);
+      wrapped += length;
+    } while (wrapped < line_length && layout->rows_count < rows);
+    if (wrapped < line_length) break;
+
+    line += line_length + 1;
+  }
+  layout->complete = (line >= layout->notes_length);
+}
+
+const Notes_preview_layout *_notes_preview_layout(const char *notes, unsigned int width, unsigned int rows) {
+  const unsigned int hash = cstr_hash(notes);
+  const unsigned int notes_length = strlen(notes);
+  Notes_preview_layout *layout = &notes_preview_cache[hash & (NOTES_PREVIEW_CACHE_SIZE-1)];
+
+  const bool cached = layout->used && layout->hash == hash && layout->notes_length == notes_length && layout->width == width
+                      && (layout->complete || layout->rows_count >= rows);
+  if (cached) return layout;
+
+  layout->used = true;
+  layout->hash = hash;
+  layout->notes_length = notes_length;
+  layout->width = width;
+  _notes_preview_wrap(layout, notes, rows);
+  return layout;
+}
+
+void draw_notes_preview(Todo *todo, unsigned int y, unsigned int x, unsigned int height, unsigned int width) {
+  if (height < 3 || !width) return;
+
+  tui_attron(A_BOLD);
+  tui_mvaddnstr(y, x, todo->name, width);
+  tui_attroff(A_BOLD);
+  tui_mvhline(y + 1, x, 0, width);
+
+  if (!todo->notes || !*todo->notes) {
+    tui_attron(A_DIM);
+    tui_mvaddnstr(y + 2, x, "No notes", width);
+    tui_attroff(A_DIM);
+    return;
+  }
+
+  const unsigned int rows = height - 2;
+  const Notes_preview_layout *layout = _notes_preview_layout(todo->notes, width, rows);
+  for (unsigned int i = 0; i < rows && i < layout->rows_count; i++) {
+    const Notes_preview_row row = layout->rows[i];
+    if (!row.length) continue;
+
+    tui_attron(row.attributes);
+    tui_mvaddnstr(y + 2 + i, x, todo->notes + row.offset, row.length);
+    tui_attroff(row.attributes);
+  }
+}
+
+void free_notes_preview_cache() {
+  for (unsigned int i = 0; i < NOTES_PREVIEW_CACHE_SIZE; i++) free(notes_preview_cache[i].rows);
+  memset(notes_preview_cache, 0, sizeof(notes_preview_cache));
+}
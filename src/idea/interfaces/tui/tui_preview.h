@@ -0,0 +1,40 @@
+#ifndef TUI_PREVIEW_H
+#define TUI_PREVIEW_H
+
+#include <stdbool.h>
+
+#include "../../todos/todo_list.h"
+
+// Pane with the notes of a ToDo next to the list. The tasks are in bold
+// (dimmed once done or removed) and the reminders underlined.
+//
+// The wrapped rows are cached by the hash of the notes, so moving the cursor
+// across the ToDos only wraps the notes that weren't shown before or that
+// changed since. A layout only wraps as many rows as the pane can show.
+
+#define NOTES_PREVIEW_CACHE_SIZE 64 // Power of 2
+
+typedef struct {
+  unsigned int offset; // In the notes
+  unsigned int length;
+  int attributes; // ncurses attributes of the line it belongs to
+} Notes_preview_row;
+
+typedef struct {
+  bool used;
+  unsigned int hash; // Of the notes
+  unsigned int notes_length; // Guards against hash collisions
+  unsigned int width;
+  bool complete; // All the notes are wrapped, not only the first rows
+
+  Notes_preview_row *rows;
+  unsigned int rows_count;
+  unsigned int rows_capacity;
+} Notes_preview_layout;
+
+// Draws the pane in the rectangle: the name of the ToDo, a line and its
+// notes, cut at the bottom
+void draw_notes_preview(Todo *todo, unsigned int y, unsigned int x, unsigned int height, unsigned int width);
+void free_notes_preview_cache();
+
+#endif // TUI_PREVIEW_H
@@ -0,0 +1,212 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "tui_profiler.h"
+#include "../../utils/backtrace.h"
+
+unsigned int tui_profiler_ncurses_calls = 0;
+
+Tui_profiler_frame tui_profiler_frames[TUI_PROFILER_FRAMES] = {0}; // Ring
+unsigned long tui_profiler_frames_count = 0; // Recorded since the start
+Tui_profiler_frame tui_profiler_frame = {0}; // Current
+
+double tui_profiler_idle_ms = 0; // Waiting for keys, since the start
+struct {
+  double start_ms;
+  double idle_at_start_ms;
+} tui_profiler_phases[TUI_PROFILER_PHASES] = {0};
+
+FILE *tui_profiler_log = NULL;
+
+const char *tui_profiler_phase_names[TUI_PROFILER_PHASES] = {
+  [TUI_PROFILER_DRAW]      = "draw",
+  [TUI_PROFILER_REFRESH]   = "refresh",
+  [TUI_PROFILER_INPUT]     = "input",
+  [TUI_PROFILER_BACKTRACE] = "backtrace",
+};
+
+double _tui_profiler_now_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+bool tui_profiler_init() {
+  const char *log_path = getenv(TUI_PROFILER_LOG_VARIABLE);
+  if (!log_path || !*log_path) return true;
+
+  tui_profiler_log = fopen(log_path, "w");
+  if (!tui_profiler_log) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to open the profiler log '%s'", log_path);
+    return false;
+  }
+
+  fprintf(tui_profiler_log, "# frame");
+  for (unsigned int phase = 0; phase < TUI_PROFILER_PHASES; phase++) fprintf(tui_profiler_log, " %s_ms", tui_profiler_phase_names[phase]);
+  fprintf(tui_profiler_log, " frame_ms ncurses_calls\n");
+  return true;
+}
+
+void tui_profiler_free() {
+  if (tui_profiler_log) fclose(tui_profiler_log);
+  tui_profiler_log = NULL;
+}
+
+void tui_profiler_phase_start(Tui_profiler_phase phase) {
+  tui_profiler_phases[phase].start_ms = _tui_profiler_now_ms();
+  tui_profiler_phases[phase].idle_at_start_ms = tui_profiler_idle_ms;
+}
+
+void tui_profiler_phase_end(Tui_profiler_phase phase) {
+  const double elapsed = _tui_profiler_now_ms() - tui_profiler_phases[phase].start_ms;
+  const double idle = tui_profiler_idle_ms - tui_profiler_phases[phase].idle_at_start_ms;
+  tui_profiler_frame.phases[phase] += elapsed - idle;
+}
+
+double _tui_profiler_frame_ms(Tui_profiler_frame frame) {
+  double total = 0;
+  for (unsigned int phase = 0; phase < TUI_PROFILER_PHASES; phase++) total += frame.phases[phase];
+  return total;
+}
+
+void tui_profiler_frame_end() {
+  tui_profiler_frame.ncurses_calls = tui_profiler_ncurses_calls;
+
+  if (tui_profiler_log) {
+    fprintf(tui_profiler_log, "%lu", tui_profiler_frames_count);
+    for (unsigned int phase = 0; phase < TUI_PROFILER_PHASES; phase++) fprintf(tui_profiler_log, " %.3f", tui_profiler_frame.phases[phase]);
+    fprintf(tui_profiler_log, " %.3f %u\n", _tui_profiler_frame_ms(tui_profiler_frame), tui_profiler_frame.ncurses_calls);
+  }
+
+  tui_profiler_frames[tui_profiler_frames_count++ % TUI_PROFILER_FRAMES] = tui_profiler_frame;
+  tui_profiler_frame = (Tui_profiler_frame) {0};
+  tui_profiler_ncurses_calls = 0;
+}
+
+int _tui_profiler_compare_ms(const void *a, const void *b) {
+  const double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+// Of the sorted samples
+double _tui_profiler_percentile(const double *samples, unsigned int count, unsigned int percentile) {
+  return (count) ? samples[(count-1) * percentile / 100] : 0;
+}
+
+void draw_tui_profiler(unsigned int y, unsigned int x) {
+  const unsigned int count = (tui_profiler_frames_count < TUI_PROFILER_FRAMES) ? tui_profiler_frames_count : TUI_PROFILER_FRAMES;
+  double samples[TUI_PROFILER_FRAMES];
+
+  int cursor_y, cursor_x;
+  getyx(stdscr, cursor_y, cursor_x);
+  attron(A_REVERSE);
+
+  mvprintw(y++, x, " %-13s %9s %9s ", "ms", "p50", "p99");
+
+  // The phases, the whole frame (TUI_PROFILER_PHASES) and the ncurses calls
+  for (unsigned int metric = 0; metric <= TUI_PROFILER_PHASES + 1; metric++) {
+    for (unsigned int i = 0; i < count; i++) {
+      const Tui_profiler_frame frame = tui_profiler_frames[i];
+      if (metric < TUI_PROFILER_PHASES) samples[i] = frame.phases[metric];
+      else if (metric == TUI_PROFILER_PHASES) samples[i] = _tui_profiler_frame_ms(frame);
+      else samples[i] = frame.ncurses_calls;
+    }
+    qsort(samples, count, sizeof(double), _tui_profiler_compare_ms);
+
+    const double p50 = _tui_profiler_percentile(samples, count, 50), p99 = _tui_profiler_percentile(samples, count, 99);
+    if (metric < TUI_PROFILER_PHASES) mvprintw(y++, x, " %-13s %9.3f %9.3f ", tui_profiler_phase_names[metric], p50, p99);
+    else if (metric == TUI_PROFILER_PHASES) mvprintw(y++, x, " %-13s %9.3f %9.3f ", "frame", p50, p99);
+    else mvprintw(y++, x, " %-13s %9.0f %9.0f ", "ncurses calls", p50, p99);
+  }
+
+  attroff(A_REVERSE);
+  move(cursor_y, cursor_x);
+}
+
+//////////////////////////////////////////////////////
+////////////////// COUNTED NCURSES ///////////////////
+//////////////////////////////////////////////////////
+
+int tui_printw(const char *format, ...) {
+  tui_profiler_ncurses_calls++;
+  va_list args;
+  va_start(args, format);
+  const int ret = vw_printw(stdscr, format, args);
+  va_end(args);
+  return ret;
+}
+
+int tui_mvprintw(int y, int x, const char *format, ...) {
+  tui_profiler_ncurses_calls++;
+  if (move(y, x) == ERR) return ERR;
+  va_list args;
+  va_start(args, format);
+  const int ret = vw_printw(stdscr, format, args);
+  va_end(args);
+  return ret;
+}
+
+int tui_addch(chtype c) {
+  tui_profiler_ncurses_calls++;
+  return addch(c);
+}
+
+int tui_mvaddch(int y, int x, chtype c) {
+  tui_profiler_ncurses_calls++;
+  return mvaddch(y, x, c);
+}
+
+int tui_mvaddnstr(int y, int x, const char *str, int n) {
+  tui_profiler_ncurses_calls++;
+  return mvaddnstr(y, x, str, n);
+}
+
+int tui_mvhline(int y, int x, chtype c, int n) {
+  tui_profiler_ncurses_calls++;
+  return mvhline(y, x, c, n);
+}
+
+int tui_mvvline(int y, int x, chtype c, int n) {
+  tui_profiler_ncurses_calls++;
+  return mvvline(y, x, c, n);
+}
+
+int tui_move(int y, int x) {
+  tui_profiler_ncurses_calls++;
+  return move(y, x);
+}
+
+int tui_clrtoeol() {
+  tui_profiler_ncurses_calls++;
+  return clrtoeol();
+}
+
+int tui_erase() {
+  tui_profiler_ncurses_calls++;
+  return erase();
+}
+
+int tui_attron(int attributes) {
+  tui_profiler_ncurses_calls++;
+  return attron(attributes);
+}
+
+int tui_attroff(int attributes) {
+  tui_profiler_ncurses_calls++;
+  return attroff(attributes);
+}
+
+int tui_getch() {
+  const double start = _tui_profiler_now_ms();
+
+  tui_profiler_phase_start(TUI_PROFILER_REFRESH);
+  refresh();
+  tui_profiler_phase_end(TUI_PROFILER_REFRESH);
+  const int key = getch();
+
+  // Not counted in the phase that called it: the refresh has its own phase
+  tui_profiler_idle_ms += _tui_profiler_now_ms() - start;
+  return key;
+}
@@ -0,0 +1,71 @@
+#ifndef TUI_PROFILER_H
+#define TUI_PROFILER_H
+
+#include <ncurses.h>
+#include <stdbool.h>
+
+// Times the phases of each frame of the TUI (an iteration of its loop) and
+// counts the ncurses calls made in it. The last TUI_PROFILER_FRAMES frames
+// are shown in an overlay with their p50 and p99, and every frame is written
+// to the file of TUI_PROFILER_LOG_VARIABLE if it's set.
+//
+// The time spent waiting for a key isn't counted in the phases. tui_getch()
+// refreshes the screen before waiting, so the refresh is measured on its own.
+
+#define TUI_PROFILER_FRAMES 128
+#define TUI_PROFILER_LOG_VARIABLE "IDEA_TUI_PROFILER_LOG"
+#define TUI_PROFILER_OVERLAY_HEIGHT (TUI_PROFILER_PHASES + 3) // Header, frame total and ncurses calls
+
+typedef enum {
+  TUI_PROFILER_DRAW,      // draw_window
+  TUI_PROFILER_REFRESH,   // Sending the changes to the terminal
+  TUI_PROFILER_INPUT,     // parse_normal / parse_command, once the key is read
+  TUI_PROFILER_BACKTRACE, // tui_print_backtrace
+  TUI_PROFILER_PHASES,
+} Tui_profiler_phase;
+
+typedef struct {
+  double phases[TUI_PROFILER_PHASES]; // ms
+  unsigned int ncurses_calls;
+} Tui_profiler_frame;
+
+extern unsigned int tui_profiler_ncurses_calls; // Of the current frame
+
+// Opens the log file if the variable is set
+bool tui_profiler_init();
+void tui_profiler_free();
+
+// A phase can be started and ended more than once in a frame, its times are
+// added
+void tui_profiler_phase_start(Tui_profiler_phase phase);
+void tui_profiler_phase_end(Tui_profiler_phase phase);
+void tui_profiler_frame_end(); // Records the frame and starts the next one
+
+// Its ncurses calls aren't counted
+void draw_tui_profiler(unsigned int y, unsigned int x);
+
+//////////////////////////////////////////////////////
+////////////////// COUNTED NCURSES ///////////////////
+//////////////////////////////////////////////////////
+// The TUI draws through these instead of calling ncurses directly, so the
+// calls are counted in the frame. Only the calls made through them are
+// counted.
+
+int tui_printw(const char *format, ...);
+int tui_mvprintw(int y, int x, const char *format, ...);
+int tui_addch(chtype c);
+int tui_mvaddch(int y, int x, chtype c);
+int tui_mvaddnstr(int y, int x, const char *str, int n);
+int tui_mvhline(int y, int x, chtype c, int n);
+int tui_mvvline(int y, int x, chtype c, int n);
+int tui_move(int y, int x);
+int tui_clrtoeol();
+int tui_erase();
+int tui_attron(int attributes);
+int tui_attroff(int attributes);
+
+// Refreshes the screen in the TUI_PROFILER_REFRESH phase and waits for a key.
+// The wait isn't counted in the phase that called it
+int tui_getch();
+
+#endif // TUI_PROFILER_H
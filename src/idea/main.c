@@ -6,8 +6,11 @@
 #include "main.h"
 #include "utils/backtrace.h"
 #include "todos/todo_list.h"
+#include "todos/search.h"
+#include "todos/stats.h"
 #include "interfaces/tui/tui.h"
 #include "interfaces/cli/cli.h"
+#include "../utils/intern.h"
 #include "../utils/list.h"
 #include "../utils/string.h"
 
@@ -47,6 +50,10 @@ bool parse_commands_cli(char *commands[], int count) {
 
   cli_disable_colors = getenv("IDEA_CLI_DISABLE_COLORS");
 
+  // All the commands are applied atomically: if one fails, the changes of
+  // the previous ones are reverted
+  if (!todo_list_transaction_begin()) return false;
+
   if (!strcmp(commands[0], "-m")) {
     count--;
     commands++;
@@ -60,7 +67,6 @@ bool parse_commands_cli(char *commands[], int count) {
         }
       } else {
         APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "An ERROR occurred in the %dº command (%s). Idea is not saving the changes made in this instance", i+1, commands[i]);
-        todo_list_modified = false; // Try to not save it because it may be corrupted
         something_went_wrong = true;
       }
       cli_print_backtrace();
@@ -87,7 +93,6 @@ bool parse_commands_cli(char *commands[], int count) {
       }
     } else {
       APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "An ERROR occurred in the command '%s'. Idea is not saving the changes made in this instance", input.str);
-      todo_list_modified = false; // Try to not save it because it may be corrupted
       something_went_wrong = true;
     }
 
@@ -95,7 +100,10 @@ bool parse_commands_cli(char *commands[], int count) {
     cli_print_backtrace();
   }
 
-  if (todo_list_modified) action_list_todos(NULL);
+  if (something_went_wrong) todo_list_transaction_rollback();
+  else todo_list_transaction_commit();
+
+  if (todo_list_modified && cli_list_after_changes) action_list_todos(NULL);
   return !something_went_wrong;
 }
 
@@ -170,6 +178,7 @@ int main(int argc, char *argv[]) {
     free_paths();
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to load the paths");
     cli_print_backtrace();
+    list_node_pool_free();
     return RET_CODE_PATH_ERROR;
   }
 
@@ -177,6 +186,7 @@ int main(int argc, char *argv[]) {
     free_paths();
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to load the config");
     cli_print_backtrace();
+    list_node_pool_free();
     return RET_CODE_CONFIG_ERROR;
   }
 
@@ -184,6 +194,7 @@ int main(int argc, char *argv[]) {
     free_paths();
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to create the directory structure");
     cli_print_backtrace();
+    list_node_pool_free();
     return RET_CODE_CREATE_STRUCTURE_FAILED;
   }
 
@@ -191,6 +202,7 @@ int main(int argc, char *argv[]) {
     free_paths();
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to create the lock file");
     cli_print_backtrace();
+    list_node_pool_free();
     return RET_CODE_LOCK_ERROR;
   }
 
@@ -222,7 +234,12 @@ int main(int argc, char *argv[]) {
   }
 
   list_destroy(&todo_list, (void (*)(void *))free_todo);
+  free_todo_names();
+  free_stats();
+  free_search_index();
+  free_interned_strings();
   free_paths();
   cli_print_backtrace();
+  list_node_pool_free();
   return ret;
 }
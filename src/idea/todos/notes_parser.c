@@ -1,8 +1,12 @@
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "notes_parser.h"
 #include "../utils/backtrace.h"
+#include "../../utils/intern.h"
 #include "../../utils/string.h"
 
 void free_task(Task *task) {
@@ -18,7 +22,8 @@ void free_reminder(Reminder *rem) {
 void free_attributes(Todo *todo) {
   list_destroy(&todo->attributes.tasks, (void (*)(void *)) free_task);
   list_destroy(&todo->attributes.reminders, (void (*)(void *)) free_reminder);
-  list_destroy(&todo->attributes.tags, free);
+  list_destroy(&todo->attributes.tags, NULL); // Interned
+  todo->attributes.task_counters = (Task_counters){0};
 }
 
 bool is_a_task(const char *cstr, unsigned int length) {
@@ -92,42 +97,33 @@ bool parse_reminder(char *rem_str, Reminder *rem) {
     .cursor = 0,
   };
 
-  char *rem_date = next_token(&rem_input, ' ');
-  if (!rem_date || rem_date[0] == '\0') {
+  // Dates are short, so they are read into a buffer instead of the heap
+  char rem_date[32];
+  Token_view token;
+  if (!next_token_view(&rem_input, ' ', &token) || token.length == 0) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to get the date of the reminder");
-    if (rem_date) free(rem_date);
     return false;
   }
 
-  if (!load_date_from_string(rem_date, &rem->start)) {
+  if (token_view_unescape(token, ' ', rem_date, sizeof(rem_date)) >= sizeof(rem_date) || !load_date_from_string(rem_date, &rem->start)) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to parse the start date of the reminder");
-    if (rem_date) free(rem_date);
     return false;
   }
-  free(rem_date); rem_date = NULL;
 
   unsigned int marker = rem_input.cursor;
-  char *divider = next_token(&rem_input, ' ');
   // Try to see if there is an end date
-  if (divider && !strcmp(divider, "~")) {
-    free(divider);
-
-    rem_date = next_token(&rem_input, ' ');
-    if (!rem_date || rem_date[0] == '\0') {
+  if (next_token_view(&rem_input, ' ', &token) && token_view_equals(token, ' ', "~")) {
+    if (!next_token_view(&rem_input, ' ', &token) || token.length == 0) {
       APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to get the end date of the reminder");
-      if (rem_date) free(rem_date);
       return false;
     }
 
-    if (!load_date_from_string(rem_date, &rem->end)) {
+    if (token_view_unescape(token, ' ', rem_date, sizeof(rem_date)) >= sizeof(rem_date) || !load_date_from_string(rem_date, &rem->end)) {
       APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to parse the end date of the reminder");
-      free(rem_date);
       return false;
     }
-    free(rem_date);
 
   } else {
-    if (divider) free(divider);
     rem_input.cursor = marker;
     rem->end = rem->start;
   }
@@ -144,6 +140,7 @@ Task *read_task(Todo *todo, unsigned int notes_length, unsigned int *indentation
   }
 
   Task *task = malloc(sizeof(Task));
+  memset(task, 0, sizeof(Task));
   task->todo = todo;
   task->level = (*indentation) ? spaces / *indentation : 0;
   task->state = *(todo->notes + *cursor + 3);
@@ -167,6 +164,47 @@ Task *read_task(Todo *todo, unsigned int notes_length, unsigned int *indentation
   return task;
 }
 
+void _task_counters_add_state(Task_counters *counters, char state) {
+  counters->total++;
+  switch (state) {
+    case ' ': counters->pending++;   break;
+    case 'x': counters->done++;      break;
+    case '?': counters->questions++; break;
+    case '-': counters->working++;   break;
+    case '~': counters->removed++;   break;
+  }
+  if (state != 'x' && state != '~') counters->incomplete++;
+}
+
+void _task_counters_add(Task_counters *counters, Task_counters other) {
+  counters->total      += other.total;
+  counters->incomplete += other.incomplete;
+  counters->pending    += other.pending;
+  counters->done       += other.done;
+  counters->questions  += other.questions;
+  counters->working    += other.working;
+  counters->removed    += other.removed;
+}
+
+// The subtree of the task is complete: add it to the counters of its parent
+void _task_close(Task *task) {
+  if (!task->parent) return;
+  _task_counters_add_state(&task->parent->subtasks, task->state);
+  _task_counters_add(&task->parent->subtasks, task->subtasks);
+}
+
+// Links the task to its parent. `open` is the last task read, and the chain
+// of its parents are the tasks whose subtrees can still grow. Every task is
+// closed once, so building the tree is linear.
+Task *_task_tree_insert(Task *open, Task *task) {
+  while (open && open->level >= task->level) {
+    _task_close(open);
+    open = open->parent;
+  }
+  task->parent = open;
+  return task;
+}
+
 bool build_attributes(Todo *todo) {
   if (!todo) return false;
   if (!todo->notes) return true;
@@ -176,6 +214,7 @@ bool build_attributes(Todo *todo) {
 
   unsigned int notes_length = strlen(todo->notes);
   unsigned int indentation = 0;
+  Task *open_task = NULL;
 
   bool new_line = true;
   unsigned int spaces = 0;
@@ -200,7 +239,11 @@ bool build_attributes(Todo *todo) {
 
     if (is_a_task(cstr_start, cstr_length)) {
       Task *task = read_task(todo, notes_length, &indentation, spaces, &i);
-      if (task) list_append(&todo->attributes.tasks, task);
+      if (task) {
+        list_append(&todo->attributes.tasks, task);
+        _task_counters_add_state(&todo->attributes.task_counters, task->state);
+        open_task = _task_tree_insert(open_task, task);
+      }
 
     } else if (is_property("tags", cstr_start)) {
       char *tags = read_property("tags", todo->notes, notes_length, &i);
@@ -210,8 +253,8 @@ bool build_attributes(Todo *todo) {
         .cursor = 0,
         .length = strlen(tags),
       };
-      char *tag = NULL;
-      while ( (tag = next_token(&tags_input, ' ')) ) list_append(&todo->attributes.tags, tag);
+      Token_view tag;
+      while (next_token_view(&tags_input, ' ', &tag)) list_append(&todo->attributes.tags, (char *) intern_token_view(tag, ' '));
 
       free(tags);
 
@@ -226,6 +269,7 @@ bool build_attributes(Todo *todo) {
       if (!ok) {
         APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to parse the %dº reminder from the ToDo '%s'", todo->attributes.reminders.count+1, todo->name);
         free(rem);
+        todo->attributes.failed = true;
         return false;
       }
 
@@ -233,6 +277,7 @@ bool build_attributes(Todo *todo) {
         if (todo->attributes.tasks.count <= 0) {
           APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to associate the %dº reminder to a task from the ToDo '%s'", todo->attributes.reminders.count+1, todo->name);
           free(rem);
+          todo->attributes.failed = true;
           return false;
         }
 
@@ -246,10 +291,126 @@ bool build_attributes(Todo *todo) {
     spaces = 0;
   }
 
+  for (; open_task; open_task = open_task->parent) _task_close(open_task);
+
   todo->attributes.generated = true;
+  todo->attributes.failed = false;
   return true;
 }
 
+typedef struct {
+  List backtrace;
+  bool failed; // The batch stopped at the ToDo that failed
+} Attributes_batch;
+
+typedef struct {
+  Todo **todos;
+  unsigned int todos_count;
+  Attributes_batch *batches;
+  unsigned int batches_count;
+  atomic_uint next_batch;
+  atomic_uint first_failed_batch; // batches_count if none failed
+} Attributes_stage;
+
+typedef struct {
+  Attributes_stage *stage;
+  List_node_pool pool; // The nodes of the attribute lists built by the thread
+} Attributes_worker;
+
+void _attributes_build_batches(Attributes_stage *stage) {
+  List *outer_backtrace = current_backtrace;
+
+  unsigned int b;
+  while ((b = atomic_fetch_add(&stage->next_batch, 1)) < stage->batches_count) {
+    // The batches are taken in order, so the next ones are after the failure too
+    if (b > atomic_load(&stage->first_failed_batch)) break;
+
+    Attributes_batch *batch = &stage->batches[b];
+    current_backtrace = &batch->backtrace;
+    const unsigned int end = (b+1) * ATTRIBUTES_BATCH_SIZE;
+    for (unsigned int i = b * ATTRIBUTES_BATCH_SIZE; i < end && i < stage->todos_count; i++) {
+      if (!build_attributes(stage->todos[i])) {
+        batch->failed = true;
+        break;
+      }
+    }
+
+    unsigned int first_failed = atomic_load(&stage->first_failed_batch);
+    while (batch->failed && b < first_failed && !atomic_compare_exchange_weak(&stage->first_failed_batch, &first_failed, b));
+  }
+
+  current_backtrace = outer_backtrace;
+}
+
+void *_attributes_worker(void *arg) {
+  Attributes_worker *worker = arg;
+  _attributes_build_batches(worker->stage);
+  worker->pool = list_node_pool_detach();
+  return NULL;
+}
+
+bool build_attributes_of_todo_list(List todos) {
+  Todo **pending = malloc((list_size(todos) + 1) * sizeof(Todo *));
+  if (!pending) abort();
+
+  unsigned int pending_count = 0;
+  List_iterator iterator = list_iterator_create(todos);
+  while (list_iterator_next(&iterator)) {
+    Todo *todo = list_iterator_element(iterator);
+    if (todo->notes && !todo->attributes.generated) pending[pending_count++] = todo;
+  }
+
+  const unsigned int batches_count = (pending_count + ATTRIBUTES_BATCH_SIZE - 1) / ATTRIBUTES_BATCH_SIZE;
+  Attributes_stage stage = {
+    .todos = pending,
+    .todos_count = pending_count,
+    .batches = calloc(batches_count + 1, sizeof(Attributes_batch)),
+    .batches_count = batches_count,
+  };
+  if (!stage.batches) abort();
+  atomic_init(&stage.next_batch, 0);
+  atomic_init(&stage.first_failed_batch, batches_count);
+
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned int threads_count = (cores > 1) ? cores : 1;
+  if (threads_count > ATTRIBUTES_MAX_THREADS) threads_count = ATTRIBUTES_MAX_THREADS;
+  if (threads_count > batches_count) threads_count = batches_count;
+  if (pending_count < ATTRIBUTES_PARALLEL_MINIMUM_TODOS) threads_count = 1;
+
+  // The calling thread takes batches too, so it finishes the work of any
+  // thread that couldn't be created
+  Attributes_worker workers[ATTRIBUTES_MAX_THREADS];
+  pthread_t threads[ATTRIBUTES_MAX_THREADS];
+  bool started[ATTRIBUTES_MAX_THREADS] = {0};
+  for (unsigned int t = 1; t < threads_count; t++) {
+    workers[t] = (Attributes_worker){ .stage = &stage };
+    started[t] = !pthread_create(&threads[t], NULL, _attributes_worker, &workers[t]);
+  }
+
+  _attributes_build_batches(&stage);
+  for (unsigned int t = 1; t < threads_count; t++) {
+    if (!started[t]) continue;
+    pthread_join(threads[t], NULL);
+    list_node_pool_adopt(workers[t].pool);
+  }
+
+  bool ok = true;
+  for (unsigned int b = 0; b < batches_count; b++) {
+    if (ok) {
+      List_iterator backtrace_iterator = list_iterator_create(stage.batches[b].backtrace);
+      while (list_iterator_next(&backtrace_iterator)) list_append(current_backtrace, list_iterator_element(backtrace_iterator));
+      list_destroy(&stage.batches[b].backtrace, NULL);
+      ok = !stage.batches[b].failed;
+    } else {
+      list_destroy(&stage.batches[b].backtrace, (void (*)(void *))free_backtrace_item);
+    }
+  }
+
+  free(stage.batches);
+  free(pending);
+  return ok;
+}
+
 bool is_reminder_old(Reminder rem) {
   const Date now = date_now();
 
@@ -329,16 +490,28 @@ bool is_task_incomplete(Task task) {
   return task.state != 'x' && task.state != '~';
 }
 
+bool task_has_incomplete_subtasks(Task task) {
+  return task.subtasks.incomplete > 0;
+}
+
+unsigned int task_counters_progress(Task_counters counters) {
+  const unsigned int considered = counters.total - counters.removed;
+  if (considered == 0) return 100;
+  return counters.done * 100 / considered;
+}
+
 bool is_reminder_near(Reminder rem) {
   return is_reminder_old(rem) || is_reminder_triggered(rem) || is_reminder_upcoming(rem);
 }
 
 bool comparator_equals_tag(void *t1, void *t2) {
-  return !strcmp(t1, t2);
+  return t1 == t2; // Interned
 }
 
 // NOTE Memory allocation: Just free the attributes list nodes, not the items
 bool get_attributes_from_todo_list(List todos, Attribute_type attr_type, List *attributes) {
+  if (!build_attributes_of_todo_list(todos)) return false;
+
   List_iterator todo_list_iterator = list_iterator_create(todos);
   while (list_iterator_next(&todo_list_iterator)) {
     Todo *todo = list_iterator_element(todo_list_iterator);
@@ -4,11 +4,17 @@
 #include "todo_list.h"
 #include "../utils/date.h"
 
-typedef struct {
+// The tasks of a ToDo are kept in order of appearance, which is a preorder
+// walk of the task tree: the subtasks of a task are the tasks that follow it
+// with a greater level.
+typedef struct Task {
   Todo *todo;
   char *msg;
   char state;
   unsigned int level;
+
+  struct Task *parent;    // NULL for the top level tasks
+  Task_counters subtasks; // Aggregated over all the descendants
 } Task;
 
 typedef struct {
@@ -25,10 +31,14 @@ typedef enum {
 } Attribute_type;
 
 // Tasks
+bool is_a_task(const char *cstr, unsigned int length); // "- [ ] " (the state can be ' ', x, ?, - or ~)
 bool is_task_incomplete(Task task);
+bool task_has_incomplete_subtasks(Task task);
+unsigned int task_counters_progress(Task_counters counters); // Percentage of the (not removed) tasks that are done
 
 // Properties: tags, reminders
 // The properties are special keywords at the start of the line.
+bool is_property(const char *property_name, const char *cstr); // "<property_name>: "
 
 // Reminders
 bool is_reminder_old(Reminder rem);
@@ -41,6 +51,16 @@ Reminder *reminder_insertion_comparator(Reminder *rem1, Reminder *rem2);
 bool build_attributes(Todo *todo);
 void free_attributes(Todo *todo);
 
+// Builds the attributes of all the ToDos of the list in parallel. The threads
+// take batches of ToDos in order, and each batch collects its errors in its
+// own backtrace. They are merged afterwards in the order of the list, up to
+// the first ToDo that failed, so the result is the same as building them one
+// after another until the first error.
+#define ATTRIBUTES_MAX_THREADS 64
+#define ATTRIBUTES_BATCH_SIZE 16
+#define ATTRIBUTES_PARALLEL_MINIMUM_TODOS 256 // With fewer ToDos to build, the calling thread builds all of them
+bool build_attributes_of_todo_list(List todos);
+
 bool get_attributes_from_todo_list(List todos, Attribute_type attr_type, List *attributes); // TODO
 
 #endif // NOTES_PARSER_H
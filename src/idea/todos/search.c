@@ -0,0 +1,380 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "search.h"
+#include "../main.h"
+#include "../utils/backtrace.h"
+
+#define SEARCH_INDEX_MINIMUM_CAPACITY 4096
+#define SEARCH_POSTINGS_MINIMUM_CAPACITY 4
+
+typedef struct {
+  unsigned int trigram; // 0 if the slot is empty
+  unsigned int *ids;    // Sorted, because the ids only grow
+  unsigned int count;
+  unsigned int capacity;
+} Trigram_postings;
+
+struct {
+  bool valid;
+  unsigned int searches; // Searches done by this instance
+
+  // id -> ToDo. Untracking a ToDo only clears its entry (the postings keep
+  // the id), and the index is rebuilt when most of the ids are dead
+  Todo **todos;
+  unsigned int todos_count; // Ids issued (the id 0 is never used)
+  unsigned int todos_capacity;
+  unsigned int dead;
+
+  // Open addressing map trigram -> postings
+  Trigram_postings *table;
+  unsigned int capacity;
+  unsigned int used;
+} search_index = {0};
+
+char _search_lower(char c) {
+  return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+unsigned int _trigram(const char *str) {
+  return ((unsigned char) _search_lower(str[0]) << 16)
+       | ((unsigned char) _search_lower(str[1]) << 8)
+       |  (unsigned char) _search_lower(str[2]);
+}
+
+// `pattern` is lowercase. Returns the position of the first match or -1
+long _search_find(const char *text, unsigned int length, const char *pattern, unsigned int pattern_length) {
+  if (pattern_length > length) return -1;
+
+  const char first = pattern[0];
+  for (unsigned int i = 0; i <= length - pattern_length; i++) {
+    if (_search_lower(text[i]) != first) continue;
+
+    unsigned int j = 1;
+    while (j < pattern_length && _search_lower(text[i+j]) == pattern[j]) j++;
+    if (j == pattern_length) return i;
+  }
+  return -1;
+}
+
+bool _search_todo_matches(const Todo *todo, const char *pattern, unsigned int pattern_length) {
+  if (_search_find(todo->name, strlen(todo->name), pattern, pattern_length) >= 0) return true;
+  return todo->notes && _search_find(todo->notes, strlen(todo->notes), pattern, pattern_length) >= 0;
+}
+
+/// INDEX
+
+Trigram_postings *_search_index_slot(unsigned int trigram) {
+  const unsigned int mask = search_index.capacity-1;
+  unsigned int i = (trigram * 2654435761u) & mask;
+  while (search_index.table[i].trigram && search_index.table[i].trigram != trigram) i = (i+1) & mask;
+  return &search_index.table[i];
+}
+
+void _search_index_grow() {
+  Trigram_postings *old_table = search_index.table;
+  const unsigned int old_capacity = search_index.capacity;
+
+  search_index.capacity = (old_capacity) ? old_capacity*2 : SEARCH_INDEX_MINIMUM_CAPACITY;
+  search_index.table = calloc(search_index.capacity, sizeof(Trigram_postings));
+  if (!search_index.table) abort();
+
+  for (unsigned int i = 0; i < old_capacity; i++) {
+    if (old_table[i].trigram) *_search_index_slot(old_table[i].trigram) = old_table[i];
+  }
+  free(old_table);
+}
+
+void _search_index_add_trigram(unsigned int trigram, unsigned int id) {
+  if ((search_index.used+1)*2 > search_index.capacity) _search_index_grow();
+
+  Trigram_postings *postings = _search_index_slot(trigram);
+  if (!postings->trigram) {
+    postings->trigram = trigram;
+    search_index.used++;
+  }
+
+  // The ToDo is indexed at once, so its repeated trigrams are consecutive
+  if (postings->count && postings->ids[postings->count-1] == id) return;
+
+  if (postings->count == postings->capacity) {
+    postings->capacity = (postings->capacity) ? postings->capacity*2 : SEARCH_POSTINGS_MINIMUM_CAPACITY;
+    postings->ids = realloc(postings->ids, postings->capacity * sizeof(unsigned int));
+    if (!postings->ids) abort();
+  }
+  postings->ids[postings->count++] = id;
+}
+
+void _search_index_add_text(const char *text, unsigned int id) {
+  if (!text) return;
+  for (unsigned int i = 0; text[i] && text[i+1] && text[i+2]; i++) _search_index_add_trigram(_trigram(text + i), id);
+}
+
+bool _search_index_contains(const Todo *todo) {
+  const unsigned int id = todo->search_id;
+  return search_index.valid && id && id < search_index.todos_count && search_index.todos[id] == todo;
+}
+
+void _search_index_clear() {
+  for (unsigned int i = 0; i < search_index.capacity; i++) free(search_index.table[i].ids);
+  free(search_index.table);
+  free(search_index.todos);
+
+  search_index.valid = false;
+  search_index.todos = NULL;
+  search_index.todos_count = search_index.todos_capacity = search_index.dead = 0;
+  search_index.table = NULL;
+  search_index.capacity = search_index.used = 0;
+}
+
+void _search_index_build() {
+  _search_index_clear();
+  search_index.valid = true;
+
+  List_iterator iterator = list_iterator_create(todo_list);
+  while (list_iterator_next(&iterator)) search_index_track(list_iterator_element(iterator));
+}
+
+void search_index_track(Todo *todo) {
+  if (!search_index.valid || _search_index_contains(todo)) return;
+
+  if (search_index.todos_count == 0) search_index.todos_count = 1; // The id 0 is not used
+  if (search_index.todos_count >= search_index.todos_capacity) {
+    search_index.todos_capacity = (search_index.todos_capacity) ? search_index.todos_capacity*2 : 64;
+    search_index.todos = realloc(search_index.todos, search_index.todos_capacity * sizeof(Todo *));
+    if (!search_index.todos) abort();
+  }
+
+  const unsigned int id = search_index.todos_count++;
+  search_index.todos[id] = todo;
+  todo->search_id = id;
+
+  _search_index_add_text(todo->name, id);
+  _search_index_add_text(todo->notes, id);
+}
+
+bool search_index_untrack(Todo *todo) {
+  if (!_search_index_contains(todo)) return false;
+
+  search_index.todos[todo->search_id] = NULL;
+  todo->search_id = 0;
+  search_index.dead++;
+
+  // Most of the postings are dead ids
+  if (search_index.dead * 2 > search_index.todos_count) search_index_invalidate();
+  return true;
+}
+
+void search_index_transfer(Todo *from, Todo *to) {
+  if (!_search_index_contains(from)) return;
+
+  search_index.todos[from->search_id] = to;
+  to->search_id = from->search_id;
+  from->search_id = 0;
+}
+
+void search_index_invalidate() {
+  if (search_index.valid) _search_index_clear();
+}
+
+void free_search_index() {
+  _search_index_clear();
+}
+
+/// BRUTE FORCE
+
+typedef struct {
+  Todo **todos;
+  bool *matches;
+  unsigned int start;
+  unsigned int end;
+  const char *pattern;
+  unsigned int pattern_length;
+} Search_chunk;
+
+void *_search_chunk(void *chunk_p) {
+  Search_chunk *chunk = chunk_p;
+  for (unsigned int i = chunk->start; i < chunk->end; i++) {
+    chunk->matches[i] = _search_todo_matches(chunk->todos[i], chunk->pattern, chunk->pattern_length);
+  }
+  return NULL;
+}
+
+// Marks in `matches` (indexed by position) the ToDos that match the pattern
+void _search_brute_force(Todo **todos, unsigned int todos_count, const char *pattern, unsigned int pattern_length, bool *matches) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned int threads_count = (cores > 1) ? cores : 1;
+  if (threads_count > SEARCH_MAX_THREADS) threads_count = SEARCH_MAX_THREADS;
+  if (todos_count < SEARCH_PARALLEL_MINIMUM_TODOS) threads_count = 1;
+
+  Search_chunk chunks[SEARCH_MAX_THREADS];
+  pthread_t threads[SEARCH_MAX_THREADS];
+  bool started[SEARCH_MAX_THREADS] = {0};
+
+  const unsigned int chunk_size = (todos_count + threads_count - 1) / threads_count;
+  for (unsigned int t = 0; t < threads_count; t++) {
+    const unsigned int start = t * chunk_size;
+    const unsigned int end = (start + chunk_size < todos_count) ? start + chunk_size : todos_count;
+    chunks[t] = (Search_chunk){ todos, matches, (start < end) ? start : end, end, pattern, pattern_length };
+
+    // The calling thread scans the first chunk, and any chunk whose thread
+    // couldn't be created
+    if (t > 0) started[t] = !pthread_create(&threads[t], NULL, _search_chunk, &chunks[t]);
+  }
+
+  _search_chunk(&chunks[0]);
+  for (unsigned int t = 1; t < threads_count; t++) {
+    if (started[t]) pthread_join(threads[t], NULL);
+    else _search_chunk(&chunks[t]);
+  }
+}
+
+/// INDEXED SEARCH
+
+bool _postings_contains(const Trigram_postings *postings, unsigned int id) {
+  unsigned int low = 0, high = postings->count;
+  while (low < high) {
+    const unsigned int middle = low + (high - low) / 2;
+    if (postings->ids[middle] == id) return true;
+    if (postings->ids[middle] < id) low = middle + 1;
+    else high = middle;
+  }
+  return false;
+}
+
+// Marks in `matches` (indexed by id) the ToDos that match the pattern
+void _search_with_index(const char *pattern, unsigned int pattern_length, bool *matches) {
+  if (!search_index.table) return; // Nothing indexed
+
+  const unsigned int trigrams_count = pattern_length - 2;
+  const Trigram_postings **postings = malloc(trigrams_count * sizeof(Trigram_postings *));
+  if (!postings) abort();
+
+  // The ToDos must have every trigram: start from the rarest one
+  unsigned int rarest = 0;
+  for (unsigned int i = 0; i < trigrams_count; i++) {
+    postings[i] = _search_index_slot(_trigram(pattern + i));
+    if (!postings[i]->trigram) {
+      free(postings);
+      return;
+    }
+    if (postings[i]->count < postings[rarest]->count) rarest = i;
+  }
+
+  Todo **candidates = malloc(postings[rarest]->count * sizeof(Todo *));
+  unsigned int *candidate_ids = malloc(postings[rarest]->count * sizeof(unsigned int));
+  if (!candidates || !candidate_ids) abort();
+
+  unsigned int candidates_count = 0;
+  for (unsigned int p = 0; p < postings[rarest]->count; p++) {
+    const unsigned int id = postings[rarest]->ids[p];
+    if (!search_index.todos[id]) continue;
+
+    bool candidate = true;
+    for (unsigned int i = 0; i < trigrams_count && candidate; i++) {
+      if (i != rarest) candidate = _postings_contains(postings[i], id);
+    }
+    if (!candidate) continue;
+
+    candidates[candidates_count] = search_index.todos[id];
+    candidate_ids[candidates_count++] = id;
+  }
+  free(postings);
+
+  // The trigrams can be in different places of the text, so the candidates
+  // are verified. With common trigrams they can be most of the ToDos
+  bool *candidate_matches = calloc(candidates_count + 1, sizeof(bool));
+  if (!candidate_matches) abort();
+  _search_brute_force(candidates, candidates_count, pattern, pattern_length, candidate_matches);
+  for (unsigned int c = 0; c < candidates_count; c++) matches[candidate_ids[c]] = candidate_matches[c];
+
+  free(candidate_matches);
+  free(candidate_ids);
+  free(candidates);
+}
+
+/// SEARCH
+
+void _search_result_add_lines(Search_result *result, const char *pattern, unsigned int pattern_length) {
+  result->name_match = _search_find(result->todo->name, strlen(result->todo->name), pattern, pattern_length) >= 0;
+
+  const char *line = result->todo->notes;
+  for (unsigned long line_nr = 1; line; line_nr++) {
+    const char *end = strchr(line, '\n');
+    const unsigned int length = (end) ? (unsigned int)(end - line) : strlen(line);
+
+    if (_search_find(line, length, pattern, pattern_length) >= 0) list_append(&result->lines, (void *) line_nr);
+    line = (end) ? end + 1 : NULL;
+  }
+}
+
+bool search_todos(const char *pattern, List *results) {
+  if (!pattern || !results) return false;
+
+  const unsigned int pattern_length = strlen(pattern);
+  if (pattern_length == 0) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "The search pattern can't be empty");
+    return false;
+  }
+
+  char *lower_pattern = malloc(pattern_length + 1);
+  if (!lower_pattern) abort();
+  for (unsigned int i = 0; i <= pattern_length; i++) lower_pattern[i] = _search_lower(pattern[i]);
+
+  search_index.searches++;
+  const bool use_index = pattern_length >= 3 && (search_index.valid || search_index.searches > 1);
+  if (use_index && !search_index.valid) _search_index_build();
+
+  const unsigned int todos_count = list_size(todo_list);
+  Todo **todos = NULL;
+  bool *matches = NULL;
+
+  if (use_index) {
+    matches = calloc(search_index.todos_count + 1, sizeof(bool));
+    if (!matches) abort();
+    _search_with_index(lower_pattern, pattern_length, matches);
+
+  } else {
+    todos = malloc((todos_count + 1) * sizeof(Todo *));
+    matches = calloc(todos_count + 1, sizeof(bool));
+    if (!todos || !matches) abort();
+
+    List_iterator iterator = list_iterator_create(todo_list);
+    while (list_iterator_next(&iterator)) todos[list_iterator_index(iterator)] = list_iterator_element(iterator);
+    _search_brute_force(todos, todos_count, lower_pattern, pattern_length, matches);
+  }
+
+  List_iterator iterator = list_iterator_create(todo_list);
+  while (list_iterator_next(&iterator)) {
+    Todo *todo = list_iterator_element(iterator);
+    const unsigned int position = list_iterator_index(iterator);
+    bool match = false;
+    if (!use_index)                          match = matches[position];
+    else if (_search_index_contains(todo))   match = matches[todo->search_id];
+    else                                     match = _search_todo_matches(todo, lower_pattern, pattern_length);
+    if (!match) continue;
+
+    Search_result *result = malloc(sizeof(Search_result));
+    if (!result) abort();
+    *result = (Search_result){ .todo = todo, .position = position };
+    result->lines = list_new();
+    _search_result_add_lines(result, lower_pattern, pattern_length);
+    list_append(results, result);
+  }
+
+  free(todos);
+  free(matches);
+  free(lower_pattern);
+  return true;
+}
+
+void _free_search_result(Search_result *result) {
+  list_destroy(&result->lines, NULL);
+  free(result);
+}
+
+void free_search_results(List *results) {
+  list_destroy(results, (void (*)(void *)) _free_search_result);
+}
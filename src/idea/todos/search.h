@@ -0,0 +1,41 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdbool.h>
+
+#include "todo_list.h"
+
+#define SEARCH_MAX_THREADS 64
+#define SEARCH_PARALLEL_MINIMUM_TODOS 1024 // Smaller lists are scanned by a single thread
+
+// Case insensitive (ASCII) search of a literal pattern in the names and the
+// notes of todo_list.
+//
+// The trigram index maps every 3 characters sequence to the ToDos that
+// contain it, so a search only verifies the ToDos that have all the trigrams
+// of the pattern. It's maintained like the stats (see stats.h): a ToDo is
+// tracked when it's added, untracked when it's removed or its name or notes
+// change, and loading the list or rolling back a transaction invalidates it.
+// Building the index costs more than scanning the notes once, so the first
+// search of an instance scans the ToDos in parallel, and the index is built
+// by the following one. Patterns shorter than a trigram are always scanned.
+
+typedef struct {
+  Todo *todo;
+  unsigned int position; // 0-based position in todo_list
+  bool name_match;
+  List lines; // Line numbers (1-based) of the notes that match, stored as pointers
+} Search_result;
+
+// Returns false if the search couldn't be done. `results` is a list of
+// Search_result sorted by position; free it with free_search_results()
+bool search_todos(const char *pattern, List *results);
+void free_search_results(List *results);
+
+void search_index_track(Todo *todo);
+bool search_index_untrack(Todo *todo); // Returns if the ToDo was indexed
+void search_index_transfer(Todo *from, Todo *to); // `to` replaces `from`, with the same name and notes
+void search_index_invalidate();
+void free_search_index();
+
+#endif // SEARCH_H
@@ -0,0 +1,243 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "stats.h"
+#include "notes_parser.h"
+#include "../main.h"
+#include "../utils/backtrace.h"
+#include "../../utils/intern.h"
+
+#define STATS_TAGS_MINIMUM_CAPACITY 64
+
+struct {
+  bool valid;
+  // A ToDo is counted if its stats_generation is this one. Invalidating the
+  // stats starts a new generation, so the old marks don't need to be cleared
+  unsigned int generation;
+  Date day; // The reminders are classified with this date
+
+  Todo_list_stats counters;
+
+  // Tracked ToDos whose notes haven't been parsed yet. They are counted on the
+  // next read, so changing the notes doesn't parse them (nor reports their
+  // errors) until the stats are needed
+  List pending;
+
+  // Open addressing map of interned tag -> frequency. The tags are never
+  // removed from the map, their count just drops to 0
+  Tag_frequency *tags;
+  unsigned int tags_capacity;
+  unsigned int tags_used; // Slots in use (with any count)
+} stats = { .generation = 1 };
+
+Tag_frequency *_stats_tag_slot(const char *tag) {
+  const unsigned int mask = stats.tags_capacity-1;
+  unsigned int i = ((unsigned long) tag >> 4) & mask;
+  while (stats.tags[i].tag && stats.tags[i].tag != tag) i = (i+1) & mask;
+  return &stats.tags[i];
+}
+
+void _stats_tags_grow() {
+  Tag_frequency *old_tags = stats.tags;
+  const unsigned int old_capacity = stats.tags_capacity;
+
+  stats.tags_capacity = (old_capacity) ? old_capacity*2 : STATS_TAGS_MINIMUM_CAPACITY;
+  stats.tags = calloc(stats.tags_capacity, sizeof(Tag_frequency));
+  if (!stats.tags) abort();
+
+  for (unsigned int i = 0; i < old_capacity; i++) {
+    if (old_tags[i].tag) *_stats_tag_slot(old_tags[i].tag) = old_tags[i];
+  }
+  free(old_tags);
+}
+
+void _stats_add_tag(const char *tag, int delta) {
+  if ((stats.tags_used+1)*2 > stats.tags_capacity) _stats_tags_grow();
+
+  Tag_frequency *slot = _stats_tag_slot(tag);
+  if (!slot->tag) {
+    slot->tag = tag;
+    stats.tags_used++;
+  }
+
+  if (slot->count == 0 && delta > 0) stats.counters.tags++;
+  slot->count += delta;
+  if (slot->count == 0) stats.counters.tags--;
+}
+
+void _reminder_counters_add(Reminder_counters *counters, const Reminder *rem, int delta) {
+  if (is_reminder_old(*rem))            counters->old += delta;
+  else if (is_reminder_triggered(*rem)) counters->triggered += delta;
+  else if (is_reminder_upcoming(*rem))  counters->upcoming += delta;
+  else                                  counters->later += delta;
+}
+
+void _task_counters_apply(Task_counters *counters, Task_counters other, int delta) {
+  counters->total      += delta * other.total;
+  counters->incomplete += delta * other.incomplete;
+  counters->pending    += delta * other.pending;
+  counters->done       += delta * other.done;
+  counters->questions  += delta * other.questions;
+  counters->working    += delta * other.working;
+  counters->removed    += delta * other.removed;
+}
+
+// Adds (delta = 1) or subtracts (delta = -1) the ToDo. Its attributes must be built
+void _stats_apply_todo(const Todo *todo, int delta) {
+  stats.counters.todos += delta;
+  if (todo->notes) stats.counters.todos_with_notes += delta;
+  if (todo->attributes.task_counters.total) stats.counters.todos_with_tasks += delta;
+  _task_counters_apply(&stats.counters.tasks, todo->attributes.task_counters, delta);
+
+  List_iterator iterator = list_iterator_create(todo->attributes.reminders);
+  while (list_iterator_next(&iterator)) _reminder_counters_add(&stats.counters.reminders, list_iterator_element(iterator), delta);
+
+  iterator = list_iterator_create(todo->attributes.tags);
+  while (list_iterator_next(&iterator)) _stats_add_tag(list_iterator_element(iterator), delta);
+}
+
+bool _stats_count_todo(Todo *todo) {
+  if (!build_attributes(todo)) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to build the attributes of the ToDo '%s'", todo->name);
+    return false;
+  }
+  _stats_apply_todo(todo, 1);
+  todo->stats_generation = stats.generation;
+  todo->stats_pending = false;
+  return true;
+}
+
+bool _stats_count_pending() {
+  while (!list_is_empty(stats.pending)) {
+    if (!_stats_count_todo(list_remove(&stats.pending, 0))) {
+      stats_invalidate();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool _stats_rebuild() {
+  stats.counters = (Todo_list_stats){0};
+  if (stats.tags) memset(stats.tags, 0, stats.tags_capacity * sizeof(Tag_frequency));
+  stats.tags_used = 0;
+  stats.day = date_now();
+
+  // Built in parallel, so the loop below only counts them
+  if (!build_attributes_of_todo_list(todo_list)) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to build the attributes of the ToDos");
+    stats_invalidate();
+    return false;
+  }
+
+  List_iterator iterator = list_iterator_create(todo_list);
+  while (list_iterator_next(&iterator)) {
+    if (!_stats_count_todo(list_iterator_element(iterator))) {
+      stats_invalidate();
+      return false;
+    }
+  }
+
+  stats.valid = true;
+  return true;
+}
+
+// The reminders change their class with the date
+void _stats_check_day() {
+  if (stats.valid && !is_date_equals(stats.day, date_now())) stats_invalidate();
+}
+
+const Todo_list_stats *todo_list_stats() {
+  _stats_check_day();
+  if (!stats.valid && !_stats_rebuild()) return NULL;
+  if (!_stats_count_pending()) return NULL;
+  return &stats.counters;
+}
+
+unsigned int todo_list_stats_tag_count(const char *tag) {
+  if (!todo_list_stats() || !stats.tags) return 0;
+
+  const char *interned_tag = intern(tag);
+  return _stats_tag_slot(interned_tag)->count;
+}
+
+int _tag_frequency_comparator(const void *a, const void *b) {
+  const Tag_frequency *t1 = a, *t2 = b;
+  if (t1->count != t2->count) return (t1->count < t2->count) ? 1 : -1;
+  return strcmp(t1->tag, t2->tag);
+}
+
+Tag_frequency *todo_list_stats_tags() {
+  if (!todo_list_stats()) return NULL;
+
+  Tag_frequency *tags = malloc((stats.counters.tags + 1) * sizeof(Tag_frequency));
+  if (!tags) abort();
+
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < stats.tags_capacity; i++) {
+    if (stats.tags[i].tag && stats.tags[i].count) tags[count++] = stats.tags[i];
+  }
+  qsort(tags, count, sizeof(Tag_frequency), _tag_frequency_comparator);
+  return tags;
+}
+
+void stats_track_todo(Todo *todo) {
+  _stats_check_day();
+  if (!stats.valid || todo->stats_generation == stats.generation) return;
+
+  if (todo->notes && !todo->attributes.generated) {
+    todo->stats_generation = stats.generation;
+    todo->stats_pending = true;
+    list_append(&stats.pending, todo);
+    return;
+  }
+
+  if (!_stats_count_todo(todo)) stats_invalidate();
+}
+
+bool stats_untrack_todo(Todo *todo) {
+  _stats_check_day();
+  if (!stats.valid || todo->stats_generation != stats.generation) return false;
+
+  todo->stats_generation = 0;
+  if (todo->stats_pending) {
+    todo->stats_pending = false;
+    list_remove_element(&stats.pending, todo);
+    return true;
+  }
+
+  // Only stats_transfer_todo leaves the attributes of a counted ToDo unbuilt,
+  // and they are built again from the same notes
+  if (!build_attributes(todo)) {
+    stats_invalidate();
+    return false;
+  }
+
+  _stats_apply_todo(todo, -1);
+  return true;
+}
+
+void stats_transfer_todo(Todo *from, Todo *to) {
+  to->stats_generation = from->stats_generation;
+  to->stats_pending = from->stats_pending;
+  from->stats_generation = 0;
+  from->stats_pending = false;
+
+  if (to->stats_generation == stats.generation && to->stats_pending) {
+    list_remove_element(&stats.pending, from);
+    list_append(&stats.pending, to);
+  }
+}
+
+void stats_invalidate() {
+  stats.valid = false;
+  stats.generation++;
+  list_destroy(&stats.pending, NULL);
+}
+
+void free_stats() {
+  free(stats.tags);
+  stats.tags = NULL;
+  stats.tags_capacity = stats.tags_used = 0;
+  stats_invalidate();
+}
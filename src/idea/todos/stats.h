@@ -0,0 +1,49 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+
+#include "todo_list.h"
+#include "../utils/date.h"
+
+typedef struct {
+  unsigned int old;
+  unsigned int triggered;
+  unsigned int upcoming;
+  unsigned int later;
+} Reminder_counters;
+
+typedef struct {
+  const char *tag; // Interned
+  unsigned int count; // ToDos that have the tag
+} Tag_frequency;
+
+// Statistics of todo_list. They are updated incrementally when a ToDo is
+// added, removed or its notes change; replacing the whole list (loading it or
+// rolling back a transaction) invalidates them, and they are rebuilt on the
+// next read. The reminders are classified with the date of the last rebuild,
+// so they are rebuilt when the day changes.
+typedef struct {
+  unsigned int todos;
+  unsigned int todos_with_notes;
+  unsigned int todos_with_tasks;
+  Task_counters tasks;
+  Reminder_counters reminders;
+  unsigned int tags; // Different tags in use
+} Todo_list_stats;
+
+// NULL if the attributes of some ToDo can't be built
+const Todo_list_stats *todo_list_stats();
+unsigned int todo_list_stats_tag_count(const char *tag);
+// The tags in use sorted by frequency (the caller frees the array)
+Tag_frequency *todo_list_stats_tags();
+
+// Call stats_track_todo after adding a ToDo to todo_list and
+// stats_untrack_todo before removing it or changing its notes
+void stats_track_todo(Todo *todo);
+bool stats_untrack_todo(Todo *todo); // Returns if the ToDo was being tracked
+void stats_transfer_todo(Todo *from, Todo *to); // `to` replaces `from`, with the same notes
+void stats_invalidate();
+void free_stats();
+
+#endif // STATS_H
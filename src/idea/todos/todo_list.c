@@ -1,4 +1,6 @@
 #include <ncurses.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,8 +9,11 @@
 
 #include "todo_list.h"
 #include "notes_parser.h"
+#include "search.h"
+#include "stats.h"
 #include "../../utils/tokenizer.h"
 #include "../templates/html/html.h"
+#include "../../utils/intern.h"
 #include "../../utils/list.h"
 #include "../../utils/string.h"
 
@@ -60,11 +65,47 @@ bool is_a_valid_todo_name(char *name) {
 }
 
 void free_todo(Todo *todo) {
-  free(todo->name);
-  free(todo->hostname);
-  free(todo->notes);
+  if (!(todo->arena_fields & TODO_FIELD_NAME)) free(todo->name);
+  if (!(todo->arena_fields & TODO_FIELD_NOTES)) free(todo->notes);
   free_attributes(todo);
-  free(todo);
+
+  Todo_arena *arena = todo->arena;
+  if (!arena) {
+    free(todo);
+    return;
+  }
+
+  // The ToDo itself lives in the arena
+  if (--arena->todos == 0) {
+    arena_free(&arena->arena);
+    free(arena);
+  }
+}
+
+void todo_set_name(Todo *todo, char *name) {
+  const bool indexed = search_index_untrack(todo);
+
+  if (!(todo->arena_fields & TODO_FIELD_NAME)) free(todo->name);
+  todo->arena_fields &= ~TODO_FIELD_NAME;
+  todo->name = name;
+  todo_names_invalidate();
+
+  if (indexed) search_index_track(todo);
+}
+
+void todo_set_notes(Todo *todo, char *notes) {
+  const bool tracked = stats_untrack_todo(todo);
+  const bool indexed = search_index_untrack(todo);
+
+  if (!(todo->arena_fields & TODO_FIELD_NOTES)) free(todo->notes);
+  todo->arena_fields &= ~TODO_FIELD_NOTES;
+  todo->notes = notes;
+  free_attributes(todo); // They are rebuilt from the new notes
+  todo->attributes.generated = false;
+  todo->attributes.failed = false;
+
+  if (tracked) stats_track_todo(todo);
+  if (indexed) search_index_track(todo);
 }
 
 Todo *create_todo(char *name) {
@@ -77,31 +118,505 @@ Todo *create_todo(char *name) {
   todo->creation_time = time(NULL);
   todo->notes = NULL;
   todo->attributes = (Attributes){0};
-  todo->hostname = strdup(idea_state.config.hostname);
-  if (!todo->hostname) return NULL;
+  todo->in_snapshot = false;
+  todo->in_save = false;
+  todo->attributes_pending = false;
+  todo->arena = NULL;
+  todo->arena_fields = 0;
+  todo->stats_generation = 0;
+  todo->stats_pending = false;
+  todo->search_id = 0;
+  todo->hostname = intern(idea_state.config.hostname);
 
   return todo;
 }
 
+Todo *clone_todo(const Todo *todo) {
+  Todo *clone = malloc(sizeof(Todo));
+  if (!clone) return NULL;
+  memset(clone, 0, sizeof(Todo));
+
+  clone->name = strdup(todo->name);
+  clone->hostname = todo->hostname;
+  clone->notes = (todo->notes) ? strdup(todo->notes) : NULL;
+  clone->creation_time = todo->creation_time;
+
+  if (!clone->name || (todo->notes && !clone->notes)) {
+    free_todo(clone);
+    return NULL;
+  }
+
+  return clone;
+}
+
+/// NAME INDEX
+// Hash set with the names of todo_list, so checking if a name is in use
+// doesn't traverse the whole list. Appending a ToDo adds its name to the
+// index; any other change invalidates it, and it's rebuilt on the next lookup.
+struct {
+  const char **names; // Open addressing with linear probing
+  unsigned int capacity; // Always a power of 2 (or 0)
+  unsigned int count;
+  bool valid;
+} todo_names = {0};
+
+void _todo_names_insert(const char *name) {
+  if ((todo_names.count+1)*2 > todo_names.capacity) {
+    const char **old_names = todo_names.names;
+    unsigned int old_capacity = todo_names.capacity;
+
+    todo_names.capacity = (old_capacity) ? old_capacity*2 : 64;
+    todo_names.names = calloc(todo_names.capacity, sizeof(char *));
+    if (!todo_names.names) abort();
+    todo_names.count = 0;
+
+    for (unsigned int i = 0; i < old_capacity; i++) if (old_names[i]) _todo_names_insert(old_names[i]);
+    free(old_names);
+  }
+
+  const unsigned int mask = todo_names.capacity-1;
+  unsigned int i = cstr_hash(name) & mask;
+  while (todo_names.names[i]) i = (i+1) & mask;
+  todo_names.names[i] = name;
+  todo_names.count++;
+}
+
+void _todo_names_rebuild() {
+  if (todo_names.names) memset(todo_names.names, 0, todo_names.capacity * sizeof(char *));
+  todo_names.count = 0;
+
+  List_iterator iterator = list_iterator_create(todo_list);
+  while (list_iterator_next(&iterator)) _todo_names_insert(((Todo *)list_iterator_element(iterator))->name);
+  todo_names.valid = true;
+}
+
+void todo_names_add(const Todo *todo) {
+  if (todo_names.valid) _todo_names_insert(todo->name);
+}
+
+void todo_names_invalidate() {
+  todo_names.valid = false;
+}
+
+void free_todo_names() {
+  free(todo_names.names);
+  todo_names.names = NULL;
+  todo_names.capacity = todo_names.count = 0;
+  todo_names.valid = false;
+}
+
 bool todo_exists(const char *name) {
+  if (!todo_names.valid) _todo_names_rebuild();
+  if (!todo_names.capacity) return false;
+
+  const unsigned int mask = todo_names.capacity-1;
+  for (unsigned int i = cstr_hash(name) & mask; todo_names.names[i]; i = (i+1) & mask) {
+    if (!strcmp(todo_names.names[i], name)) return true;
+  }
+  return false;
+}
+
+void todo_list_fuzzy_index_init(Fuzzy_index *index) {
+  const char **names = malloc((list_size(todo_list) + 1) * sizeof(char *));
+  if (!names) abort();
+
+  List_iterator iterator = list_iterator_create(todo_list);
+  while (list_iterator_next(&iterator)) names[list_iterator_index(iterator)] = ((Todo *)list_iterator_element(iterator))->name;
+  fuzzy_index_init(index, names, list_size(todo_list));
+}
+
+void todo_list_fuzzy_index_free(Fuzzy_index *index) {
+  free(index->names);
+  fuzzy_index_free(index);
+}
+
+/// TRANSACTIONS
+struct {
+  bool active;
+  bool modified; // Value of todo_list_modified when the transaction began
+  List snapshot; // Nodes of todo_list when the transaction began (the ToDos are shared)
+  List retired;  // ToDos of the snapshot that were removed or replaced in todo_list
+} transaction = {0};
+
+/// BACKGROUND SAVE
+struct {
+  bool running;
+  bool queued; // Another save was requested while this one was running
+  char *file_path;
+  List snapshot;  // Nodes of todo_list when the save began (the ToDos are shared)
+  List retired;   // ToDos of the snapshot that were removed or replaced in todo_list
+  List backtrace; // Of the writer thread
+  List_node_pool pool;
+  bool ok;
+  atomic_bool finished;
+  pthread_t thread;
+} background_save = {0};
+
+/// BACKGROUND ATTRIBUTES
+struct {
+  bool running;
+  Todo **todos; // In the order they are built
+  unsigned int todos_count;
+  unsigned int collected; // ToDos whose attributes were handed to the main thread
+  atomic_uint built;
+  atomic_bool cancel;
+  List retired; // ToDos that were removed or replaced in todo_list before being collected
+  List_node_pool pool;
+  pthread_t thread;
+} background_attributes = {0};
+
+// A ToDo that the snapshot of the transaction or the background save still
+// reference is cloned before modifying it, and freed when they end
+bool _todo_is_shared(const Todo *todo) {
+  return (transaction.active && todo->in_snapshot) || todo->in_save || todo->attributes_pending;
+}
+
+void _todo_retire(Todo *todo) {
+  if (transaction.active && todo->in_snapshot) list_append(&transaction.retired, todo);
+  else if (todo->in_save) list_append(&background_save.retired, todo);
+  else if (todo->attributes_pending) list_append(&background_attributes.retired, todo);
+  else free_todo(todo);
+}
+
+void _clear_snapshot_marks(List list) {
+  List_iterator iterator = list_iterator_create(list);
+  while (list_iterator_next(&iterator)) ((Todo *)list_iterator_element(iterator))->in_snapshot = false;
+}
+
+bool todo_list_in_transaction() {
+  return transaction.active;
+}
+
+bool todo_list_transaction_begin() {
+  if (transaction.active) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "A transaction is already active");
+    return false;
+  }
+
+  transaction.snapshot = list_new();
+  transaction.retired = list_new();
+  List_iterator iterator = list_iterator_create(todo_list);
+  while (list_iterator_next(&iterator)) {
+    Todo *todo = list_iterator_element(iterator);
+    todo->in_snapshot = true;
+    list_append(&transaction.snapshot, todo);
+  }
+
+  transaction.modified = todo_list_modified;
+  transaction.active = true;
+  return true;
+}
+
+bool todo_list_transaction_commit() {
+  if (!transaction.active) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "There is no active transaction to commit");
+    return false;
+  }
+
+  // Nothing references the retired ToDos anymore, unless a background save
+  // is writing them
+  transaction.active = false;
+  list_destroy(&transaction.retired, (void (*)(void *))_todo_retire);
+  list_destroy(&transaction.snapshot, NULL);
+  _clear_snapshot_marks(todo_list);
+  return true;
+}
+
+bool todo_list_transaction_rollback() {
+  if (!transaction.active) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "There is no active transaction to roll back");
+    return false;
+  }
+
+  // The ToDos created during the transaction are the only ones that are not
+  // in the snapshot
+  List_iterator iterator = list_iterator_create(todo_list);
+  while (list_iterator_next(&iterator)) {
+    Todo *todo = list_iterator_element(iterator);
+    if (!todo->in_snapshot) _todo_retire(todo);
+  }
+  list_destroy(&todo_list, NULL);
+  list_destroy(&transaction.retired, NULL);
+  todo_names_invalidate();
+  stats_invalidate();
+  search_index_invalidate();
+
+  todo_list = transaction.snapshot;
+  transaction.snapshot = list_new();
+  _clear_snapshot_marks(todo_list);
+
+  todo_list_modified = transaction.modified;
+  transaction.active = false;
+  return true;
+}
+
+void (*todo_list_copied)(Todo *original, Todo *copy) = NULL;
+
+Todo *todo_list_get_for_write(unsigned int index) {
+  List_node *node = list_node_get(todo_list, index);
+  if (!node) return NULL;
+
+  Todo *todo = node->pointer;
+  if (!_todo_is_shared(todo)) return todo;
+
+  // Copy on write: the snapshot keeps the original
+  Todo *clone = clone_todo(todo);
+  if (!clone) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to copy the ToDo '%s'", todo->name);
+    return NULL;
+  }
+  node->pointer = clone;
+  _todo_retire(todo);
+  todo_names_invalidate();
+  stats_transfer_todo(todo, clone);
+  search_index_transfer(todo, clone);
+  if (todo_list_copied) todo_list_copied(todo, clone);
+  return clone;
+}
+
+void (*todo_list_released)(Todo *todo) = NULL;
+
+void release_todo(Todo *todo) {
+  if (todo_list_released) todo_list_released(todo);
+  todo_names_invalidate();
+  stats_untrack_todo(todo);
+  search_index_untrack(todo);
+  _todo_retire(todo);
+}
+
+void *_background_save_worker(void *arg) {
+  (void) arg;
+
+  current_backtrace = &background_save.backtrace;
+  background_save.ok = save_todo_list(background_save.snapshot, background_save.file_path);
+  if (!background_save.ok) APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to save the ToDo list in '%s'", background_save.file_path);
+
+  // The nodes of the backtrace are returned to the main thread
+  background_save.pool = list_node_pool_detach();
+  atomic_store(&background_save.finished, true);
+  return NULL;
+}
+
+void _background_save_finish() {
+  pthread_join(background_save.thread, NULL);
+  list_node_pool_adopt(background_save.pool);
+  background_save.running = false;
+
+  List_iterator iterator = list_iterator_create(background_save.backtrace);
+  while (list_iterator_next(&iterator)) list_append(&backtrace, list_iterator_element(iterator));
+  list_destroy(&background_save.backtrace, NULL);
+
+  iterator = list_iterator_create(background_save.snapshot);
+  while (list_iterator_next(&iterator)) ((Todo *)list_iterator_element(iterator))->in_save = false;
+  list_destroy(&background_save.snapshot, NULL);
+  list_destroy(&background_save.retired, (void (*)(void *))_todo_retire);
+
+  // The changes that were being saved are pending again
+  if (!background_save.ok) todo_list_modified = true;
+
+  if (background_save.queued) {
+    background_save.queued = false;
+    todo_list_save_start(background_save.file_path);
+  }
+}
+
+bool todo_list_save_start(char *file_path) {
+  if (background_save.running) {
+    background_save.queued = true;
+    todo_list_modified = false;
+    return true;
+  }
+
+  background_save.file_path = file_path;
+  List_iterator iterator = list_iterator_create(todo_list);
+  while (list_iterator_next(&iterator)) {
+    Todo *todo = list_iterator_element(iterator);
+    todo->in_save = true;
+    list_append(&background_save.snapshot, todo);
+  }
+
+  atomic_store(&background_save.finished, false);
+  background_save.running = true;
+  todo_list_modified = false;
+
+  if (pthread_create(&background_save.thread, NULL, _background_save_worker, NULL)) {
+    // Save it in this thread instead
+    background_save.running = false;
+    const bool ok = save_todo_list(background_save.snapshot, file_path);
+    iterator = list_iterator_create(background_save.snapshot);
+    while (list_iterator_next(&iterator)) ((Todo *)list_iterator_element(iterator))->in_save = false;
+    list_destroy(&background_save.snapshot, NULL);
+
+    if (!ok) {
+      APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to save the ToDo list in '%s'", file_path);
+      todo_list_modified = true;
+    }
+    return ok;
+  }
+  return true;
+}
+
+bool todo_list_save_in_progress() {
+  if (background_save.running && atomic_load(&background_save.finished)) _background_save_finish();
+  return background_save.running;
+}
+
+void todo_list_save_wait() {
+  while (background_save.running) _background_save_finish();
+}
+
+void *_background_attributes_worker(void *arg) {
+  (void) arg;
+
+  // The errors are reported by the commands that build the attributes again
+  List errors = list_new();
+  current_backtrace = &errors;
+  for (unsigned int i = 0; i < background_attributes.todos_count; i++) {
+    if (atomic_load(&background_attributes.cancel)) break;
+    build_attributes(background_attributes.todos[i]);
+    list_destroy(&errors, (void (*)(void *))free_backtrace_item);
+    atomic_store(&background_attributes.built, i+1);
+  }
+
+  background_attributes.pool = list_node_pool_detach();
+  return NULL;
+}
+
+void _background_attributes_collect() {
+  const unsigned int built = atomic_load(&background_attributes.built);
+  for (; background_attributes.collected < built; background_attributes.collected++) {
+    background_attributes.todos[background_attributes.collected]->attributes_pending = false;
+  }
+}
+
+bool todo_list_attributes_start() {
+  todo_list_attributes_cancel();
+
+  Todo **todos = malloc((list_size(todo_list) + 1) * sizeof(Todo *));
+  if (!todos) abort();
+
+  unsigned int todos_count = 0;
   List_iterator iterator = list_iterator_create(todo_list);
   while (list_iterator_next(&iterator)) {
-    Todo *element = list_iterator_element(iterator);
-    if (!strcmp(element->name, name)) return true;
+    Todo *todo = list_iterator_element(iterator);
+    if (todo->notes && !todo->attributes.generated && !todo->attributes.failed) todos[todos_count++] = todo;
+  }
+
+  if (!todos_count) {
+    free(todos);
+    return true;
   }
+
+  for (unsigned int i = 0; i < todos_count; i++) todos[i]->attributes_pending = true;
+  background_attributes.todos = todos;
+  background_attributes.todos_count = todos_count;
+  background_attributes.collected = 0;
+  atomic_store(&background_attributes.built, 0);
+  atomic_store(&background_attributes.cancel, false);
+  background_attributes.running = true;
+
+  if (pthread_create(&background_attributes.thread, NULL, _background_attributes_worker, NULL)) {
+    // They are built when they are needed instead
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to start building the attributes of the ToDos");
+    for (unsigned int i = 0; i < todos_count; i++) todos[i]->attributes_pending = false;
+    free(todos);
+    background_attributes.running = false;
+    return false;
+  }
+  return true;
+}
+
+void _background_attributes_finish() {
+  pthread_join(background_attributes.thread, NULL);
+  list_node_pool_adopt(background_attributes.pool);
+  background_attributes.running = false;
+
+  // The cancelled ones are built when they are needed
+  _background_attributes_collect();
+  for (unsigned int i = background_attributes.collected; i < background_attributes.todos_count; i++) {
+    background_attributes.todos[i]->attributes_pending = false;
+  }
+  free(background_attributes.todos);
+  background_attributes.todos = NULL;
+  background_attributes.todos_count = 0;
+  list_destroy(&background_attributes.retired, (void (*)(void *))_todo_retire);
+}
+
+bool todo_list_attributes_in_progress() {
+  if (!background_attributes.running) return false;
+
+  _background_attributes_collect();
+  if (background_attributes.collected < background_attributes.todos_count) return true;
+
+  _background_attributes_finish();
   return false;
 }
 
+void todo_list_attributes_wait() {
+  if (background_attributes.running) _background_attributes_finish();
+}
+
+void todo_list_attributes_cancel() {
+  if (!background_attributes.running) return;
+
+  atomic_store(&background_attributes.cancel, true);
+  _background_attributes_finish();
+}
+
+bool todo_attributes_ready(Todo *todo) {
+  if (todo->attributes_pending || todo->attributes.failed) return false;
+  if (!todo->notes || todo->attributes.generated) return true;
+
+  // Errors in the notes are reported by the commands that need the attributes
+  List *outer_backtrace = current_backtrace;
+  List errors = list_new();
+  current_backtrace = &errors;
+  const bool ok = build_attributes(todo);
+  list_destroy(&errors, (void (*)(void *))free_backtrace_item);
+  current_backtrace = outer_backtrace;
+  return ok;
+}
+
 /// FILE OPERATIONS
-bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reached_eof) {
-  if (!load_file_path || !load_file || !reached_eof) return false;
+FILE *open_todo_list_file(const char *file_path, const char *mode) {
+  if (!strcmp(file_path, STDIO_FILEPATH)) return (mode[0] == 'r') ? stdin : stdout;
+  return fopen(file_path, mode);
+}
+
+void close_todo_list_file(FILE *file) {
+  if (file == stdin || file == stdout) {
+    fflush(file);
+    return;
+  }
+  fclose(file);
+}
+
+// Copies the rest of the input (unescaped) to the arena
+char *_arena_dup_next_token(Arena *arena, Input *input) {
+  Token_view token;
+  if (!next_token_view(input, 0, &token)) return NULL;
+
+  char *str = arena_alloc(arena, token.length + 1);
+  token_view_unescape(token, 0, str, token.length + 1);
+  return str;
+}
+
+// The file is read in a single forward pass (it never seeks), so it can be
+// a pipe or stdin. The ToDos and their strings are allocated together in a
+// new Todo_arena.
+bool load_todos_from_file(const char *load_file_path, FILE *load_file) {
+  if (!load_file_path || !load_file) return false;
   bool ret = true;
 
+  Todo_arena *load_arena = malloc(sizeof(Todo_arena));
+  if (!load_arena) abort();
+  *load_arena = (Todo_arena){ .arena = arena_new(), .todos = 0 };
+
   String_builder line = sb_new();
   unsigned int line_nr = 0;
-  char *attribute = NULL;
+  Token_view attribute;
   Todo *new_todo = NULL;
-  String_builder todo_notes = sb_new();
+  String_builder todo_notes = sb_new_in_arena(&load_arena->arena);
   enum State {
     NO_STATE,
     STATE_PROPERTIES, // Reading properties of the ToDo
@@ -121,24 +636,21 @@ bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reac
       .cursor = indentation * strlen(SAVE_FILE_INDENTATION),
       .length = line.length
     };
-    attribute = next_token(&line_input, ' ');
-    if (!attribute) {
+    if (!next_token_view(&line_input, ' ', &attribute)) {
       // I can't just do 'continue' because if some ToDo has a
       // space at the beginning of some line in its notes, it
       // would not read that line.
-      attribute = malloc(1);
-      attribute[0] = '\0';
+      attribute = (Token_view){0};
     }
 
-    if (!indentation && !strcmp(attribute, "--")) {
+    if (!indentation && token_view_equals(attribute, ' ', "--")) {
       sb_clean(&line);
-      if (attribute) free(attribute);
       continue;
     }
 
     switch (state) {
       case NO_STATE:
-        if (!indentation && !strcmp(attribute, "todo")) {
+        if (!indentation && token_view_equals(attribute, ' ', "todo")) {
           state = STATE_PROPERTIES;
 
         } else {
@@ -149,14 +661,12 @@ bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reac
         break;
 
       case STATE_PROPERTIES:
-        if (!indentation && !strcmp(attribute, "todo")) {
-          // Rewind what it read and break out of the function because it's
-          // reading the next todo, and this function only reads one ToDo
-          fseek(load_file, -1 * ((int) line.length + 1 /* \n */), SEEK_CUR);
-          state = STATE_EXIT;
-          break;
+        if (!indentation && token_view_equals(attribute, ' ', "todo")) {
+          // The previous ToDo is already in the list, so just start reading
+          // the properties of the next one
+          new_todo = NULL;
 
-        } else if (indentation == 1 && !strcmp(attribute, "name:")) {
+        } else if (indentation == 1 && token_view_equals(attribute, ' ', "name:")) {
           if (new_todo) {
             ret = false;
             APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Import file %s:%u: The name was already specified (%s)", load_file_path, line_nr, new_todo->name);
@@ -164,23 +674,24 @@ bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reac
             break;
           }
 
-          char *name = next_token(&line_input, 0);
-
+          char *name = _arena_dup_next_token(&load_arena->arena, &line_input);
 
           if (!is_a_valid_todo_name(name)) {
-            free(name);
             ret = false;
             APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Import file %s:%u: Invalid ToDo name", load_file_path, line_nr);
             state = STATE_EXIT;
             break;
           }
 
-          new_todo = malloc(sizeof(Todo));
+          new_todo = arena_alloc(&load_arena->arena, sizeof(Todo));
           memset(new_todo, 0, sizeof(Todo));
           new_todo->name = name;
+          new_todo->arena = load_arena;
+          new_todo->arena_fields = TODO_FIELD_NAME;
+          load_arena->todos++;
           list_append(&todo_list, new_todo);
-
-        } else if (indentation == 1 && !strcmp(attribute, "created:")) {
+          todo_names_add(new_todo);
+        } else if (indentation == 1 && token_view_equals(attribute, ' ', "created:")) {
           if (!new_todo) {
             ret = false;
             APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Import file %s:%u: No ToDo specified", load_file_path, line_nr);
@@ -195,26 +706,26 @@ bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reac
             break;
           }
 
-          char *creation_time_cstr = next_token(&line_input, 0);
-          if (!creation_time_cstr) {
+          Token_view creation_time_token;
+          if (!next_token_view(&line_input, 0, &creation_time_token)) {
             ret = false;
             APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Import file %s:%u: Creation time was not provided", load_file_path, line_nr);
             state = STATE_EXIT;
             break;
           }
 
+          char creation_time_cstr[32];
+          const bool fits = token_view_unescape(creation_time_token, 0, creation_time_cstr, sizeof(creation_time_cstr)) < sizeof(creation_time_cstr);
           char *end = NULL;
           new_todo->creation_time = strtoull(creation_time_cstr, &end, 10);
-          if (*end != '\0' || end == creation_time_cstr) {
-            free(creation_time_cstr);
+          if (!fits || *end != '\0' || end == creation_time_cstr) {
             ret = false;
             APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Import file %s:%u: Unable to parse the creation time", load_file_path, line_nr);
             state = STATE_EXIT;
             break;
           }
-          free(creation_time_cstr);
 
-        } else if (indentation == 1 && !strcmp(attribute, "hostname:")) {
+        } else if (indentation == 1 && token_view_equals(attribute, ' ', "hostname:")) {
           if (!new_todo) {
             ret = false;
             APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Import file %s:%u: No ToDo specified", load_file_path, line_nr);
@@ -229,7 +740,8 @@ bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reac
             break;
           }
 
-          new_todo->hostname = next_token(&line_input, 0);
+          Token_view hostname;
+          if (next_token_view(&line_input, 0, &hostname)) new_todo->hostname = intern_token_view(hostname, 0);
 
           if (!new_todo->hostname) {
             ret = false;
@@ -238,7 +750,7 @@ bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reac
             break;
           }
 
-        } else if (indentation == 1 && !strcmp(attribute, "notes_content:")) {
+        } else if (indentation == 1 && token_view_equals(attribute, ' ', "notes_content:")) {
           if (!new_todo) {
             ret = false;
             APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Import file %s:%u: No ToDo specified", load_file_path, line_nr);
@@ -258,7 +770,9 @@ bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reac
 
         } else {
           ret = false;
-          APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Import file %s:%u: Unknown attribute '%s'", load_file_path, line_nr, attribute);
+          char *attribute_cstr = token_view_dup(attribute, ' ');
+          APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Import file %s:%u: Unknown attribute '%s'", load_file_path, line_nr, attribute_cstr);
+          free(attribute_cstr);
           state = STATE_EXIT;
         }
         break;
@@ -273,17 +787,14 @@ bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reac
           }
 
           line_input.cursor = indentation * strlen(SAVE_FILE_INDENTATION);
-          char *file_content = next_token(&line_input, 0);
-          if (!file_content) {
-            sb_append(&todo_notes, "\n");
-            break;
-          }
-          sb_append_with_format(&todo_notes, "%s\n", file_content);
-          free(file_content);
+          Token_view file_content;
+          if (next_token_view(&line_input, 0, &file_content)) sb_append_token_view(&todo_notes, file_content, 0);
+          sb_append_char(&todo_notes, '\n');
 
-        } else if (indentation == 1 && !strcmp(attribute, "EOF")) {
+        } else if (indentation == 1 && token_view_equals(attribute, ' ', "EOF")) {
           new_todo->notes = todo_notes.str;
-          todo_notes = sb_new();
+          new_todo->arena_fields |= TODO_FIELD_NOTES;
+          todo_notes = sb_new_in_arena(&load_arena->arena);
           state = STATE_PROPERTIES;
 
         } else {
@@ -299,22 +810,21 @@ bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reac
         break;
     }
 
-    free(attribute); attribute = NULL;
     sb_clean(&line);
   }
 
-  if (state == NO_STATE) {
-    *reached_eof = true;
-    ret = false;
-  }
-
-  if (!sb_is_empty(todo_notes)) {
+  if (state == STATE_NOTES_CONTENT) {
     sb_free(&todo_notes);
     ret = false;
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Import file %s:%u: Unclosed 'notes_content' (you need to end 'notes_content' with 'EOF')", load_file_path, line_nr);
   }
 
+  sb_free(&todo_notes);
   sb_free(&line);
+  if (!load_arena->todos) {
+    arena_free(&load_arena->arena);
+    free(load_arena);
+  }
   return ret;
 }
 
@@ -393,15 +903,8 @@ bool save_todo_to_file(FILE *file, Todo *todo) {
   return true;
 }
 
-bool save_todo_list(List list, char *file_path) {
-  FILE *save_file = fopen(file_path, "w");
-  if (!save_file) {
-    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to create the save file '%s'", file_path);
-    return false;
-  }
-
+bool save_todo_list_to_file(List list, FILE *save_file) {
   if (fputs("-- File generated by idea. Edit this file with caution.\n", save_file) == EOF) {
-    fclose(save_file);
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to save the file header");
     return false;
   }
@@ -409,22 +912,31 @@ bool save_todo_list(List list, char *file_path) {
   List_iterator iterator = list_iterator_create(list);
   while (list_iterator_next(&iterator)) {
     if (fputs("\n", save_file) == EOF) {
-      fclose(save_file);
       APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to print a new line in the export file");
       return false;
     }
 
     if (!save_todo_to_file(save_file, list_iterator_element(iterator))) {
-      fclose(save_file);
       APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to save all the ToDos in the save file");
       return false;
     }
   }
 
-  fclose(save_file);
   return true;
 }
 
+bool save_todo_list(List list, char *file_path) {
+  FILE *save_file = open_todo_list_file(file_path, "w");
+  if (!save_file) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to create the save file '%s'", file_path);
+    return false;
+  }
+
+  bool ok = save_todo_list_to_file(list, save_file);
+  close_todo_list_file(save_file);
+  return ok;
+}
+
 bool create_dir_if_not_exists(char *dir_path) {
   struct stat st = {0};
   if (stat(dir_path, &st) != -1) return (S_ISDIR(st.st_mode));
@@ -449,7 +961,7 @@ bool create_dir_structure() {
 }
 
 bool load_todo_list(List *list, char *file_path, bool obligatory) {
-  FILE *save_file = fopen(file_path, "r");
+  FILE *save_file = open_todo_list_file(file_path, "r");
   if (!save_file) {
     if (!obligatory) return true;
 
@@ -459,20 +971,101 @@ bool load_todo_list(List *list, char *file_path, bool obligatory) {
 
   List old_list = *list;
   *list = list_new();
+  todo_names_invalidate();
+  stats_invalidate();
+  search_index_invalidate();
 
-  bool reached_eof = false;
-  while (load_todo_from_file(file_path, save_file, &reached_eof));
-  fclose(save_file);
+  bool ok = load_todos_from_file((save_file == stdin) ? "stdin" : file_path, save_file);
+  close_todo_list_file(save_file);
 
-  if (reached_eof) {
-    if (!list_is_empty(old_list)) list_destroy(&old_list, (void (*)(void *))free_todo);
+  if (ok) {
+    if (!list_is_empty(old_list)) list_destroy(&old_list, (void (*)(void *))release_todo);
   } else {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "An error has occured while parsing the ToDos file");
     if (!list_is_empty(*list)) list_destroy(list, (void (*)(void *))free_todo);
     *list = old_list;
+    todo_names_invalidate();
+    stats_invalidate();
+    search_index_invalidate();
+  }
+
+  return ok;
+}
+
+bool _todo_content_equals(const Todo *a, const Todo *b) {
+  if (a->hostname != b->hostname || a->creation_time != b->creation_time) return false; // The host names are interned
+  if (strcmp(a->name, b->name)) return false;
+  if (!a->notes || !b->notes) return a->notes == b->notes;
+  return !strcmp(a->notes, b->notes);
+}
+
+bool reload_todo_list(char *file_path, void (*replaced)(Todo *old, Todo *new)) {
+  List old_list = todo_list;
+  todo_list = list_new();
+  if (!load_todo_list(&todo_list, file_path, true)) {
+    todo_list = old_list;
+    return false;
+  }
+
+  // The old ToDos by name (the primary key), as positions + 1 in `old`
+  enum { OLD_REMOVED, OLD_KEPT, OLD_REPLACED };
+  const unsigned int old_count = list_size(old_list);
+  Todo **old = malloc((old_count + 1) * sizeof(Todo *));
+  unsigned char *state = calloc(old_count + 1, sizeof(unsigned char));
+  unsigned int capacity = 64;
+  while (capacity < old_count*2) capacity *= 2;
+  unsigned int *table = calloc(capacity, sizeof(unsigned int));
+  if (!old || !state || !table) abort();
+
+  const unsigned int mask = capacity-1;
+  List_iterator iterator = list_iterator_create(old_list);
+  while (list_iterator_next(&iterator)) {
+    const unsigned int position = list_iterator_index(iterator);
+    old[position] = list_iterator_element(iterator);
+    unsigned int i = cstr_hash(old[position]->name) & mask;
+    while (table[i]) i = (i+1) & mask;
+    table[i] = position + 1;
+  }
+
+  // The unchanged ToDos are moved to the new list with their attributes, and
+  // the parsed copies are freed. The changed and added ones are copied out of
+  // the arena of the file, so it's freed with the parsed copies instead of
+  // being kept alive by a few of them after every reload
+  for (List_node *node = todo_list.head; node; node = node->next) {
+    Todo *todo = node->pointer;
+    unsigned int i = cstr_hash(todo->name) & mask;
+    while (table[i] && strcmp(old[table[i]-1]->name, todo->name)) i = (i+1) & mask;
+
+    const unsigned int position = table[i]-1;
+    if (table[i] && _todo_content_equals(old[position], todo)) {
+      node->pointer = old[position];
+      free_todo(todo);
+      state[position] = OLD_KEPT;
+      continue;
+    }
+
+    node->pointer = clone_todo(todo);
+    if (!node->pointer) abort();
+    free_todo(todo);
+
+    if (table[i]) {
+      if (replaced) replaced(old[position], node->pointer);
+      state[position] = OLD_REPLACED;
+    }
   }
+  todo_names_invalidate();
 
-  return reached_eof;
+  for (unsigned int position = 0; position < old_count; position++) {
+    if (state[position] == OLD_KEPT) continue;
+    if (replaced && state[position] == OLD_REMOVED) replaced(old[position], NULL);
+    release_todo(old[position]);
+  }
+
+  list_destroy(&old_list, NULL);
+  free(table);
+  free(state);
+  free(old);
+  return true;
 }
 
 /// Functionality
@@ -505,6 +1098,9 @@ bool action_add_todo(Input *input) {
   }
 
   list_append(&todo_list, todo);
+  todo_names_add(todo);
+  stats_track_todo(todo);
+  search_index_track(todo);
   todo_list_modified = true;
   return true;
 }
@@ -550,6 +1146,9 @@ bool action_add_at_todo(Input *input) {
   }
 
   list_insert_at(&todo_list, todo, pos-1);
+  todo_names_add(todo);
+  stats_track_todo(todo);
+  search_index_track(todo);
   todo_list_modified = true;
   return true;
 }
@@ -581,7 +1180,7 @@ bool action_remove_todo(Input *input) {
   Todo *removed = list_remove(&todo_list, index);
   todo_list_modified = true;
 
-  free_todo(removed);
+  release_todo(removed);
   return true;
 }
 
@@ -668,9 +1267,12 @@ bool action_edit_todo(Input *input) {
     return false;
   }
 
-  Todo *todo = list_get(todo_list, pos);
-  free(todo->name);
-  todo->name = new_name;
+  Todo *todo = todo_list_get_for_write(pos);
+  if (!todo) {
+    free(new_name);
+    return false;
+  }
+  todo_set_name(todo, new_name);
   todo_list_modified = true;
   return true;
 }
@@ -696,7 +1298,7 @@ bool action_clear_todos(Input *input) {
     return false;
   }
 
-  list_destroy(&todo_list, (void (*)(void *))free_todo);
+  list_destroy(&todo_list, (void (*)(void *))release_todo);
   todo_list_modified = true;
   return true;
 }
@@ -723,18 +1325,18 @@ bool action_notes_todo_remove(Input *input) {
     free(arg);
     return false;
   }
-  Todo *todo = list_get(todo_list, pos);
   free(arg); arg = NULL;
 
-  if (!todo->notes) {
+  if (!((Todo *)list_get(todo_list, pos))->notes) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "The todo doesn't have a notes file");
     return false;
   }
 
-  free(todo->notes);
-  todo->notes = NULL;
+  Todo *todo = todo_list_get_for_write(pos);
+  if (!todo) return false;
+
+  todo_set_notes(todo, NULL);
   todo_list_modified = true;
-  todo->attributes.generated = false;
 
   return true;
 }
@@ -744,7 +1346,7 @@ void initialize_notes(Todo *todo) {
 
   // Default ToDo note template
   String_builder sb = sb_create("# %s\n\ntags: \n\n---\n\n\n", todo->name);
-  todo->notes = sb.str;
+  todo_set_notes(todo, sb.str);
   todo_list_modified = true;
 }
 
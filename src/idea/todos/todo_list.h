@@ -6,6 +6,8 @@
 #include <time.h>
 #include <stdint.h>
 
+#include "../../utils/arena.h"
+#include "../../utils/fuzzy.h"
 #include "../../utils/list.h"
 #include "../../utils/tokenizer.h"
 #include "../utils/functionality.h"
@@ -18,42 +20,158 @@
 #define SAVE_FILENAME "todos.txt"
 #define NOTES_TEMP_FILENAME "notes.md"
 
+// File path that refers to stdin (when loading) or stdout (when saving)
+#define STDIO_FILEPATH "-"
+
 #define UPCOMING_REMINDER_DAYS 10
 
+// Number of tasks in each state (see is_a_task)
+typedef struct {
+  unsigned int total;
+  unsigned int incomplete; // Every state but done and removed
+  unsigned int pending;    // [ ]
+  unsigned int done;       // [x]
+  unsigned int questions;  // [?]
+  unsigned int working;    // [-]
+  unsigned int removed;    // [~]
+} Task_counters;
+
 typedef struct {
   bool generated;
-  List tags;
+  // The last build failed. build_attributes still parses the notes again (to
+  // report the errors), but todo_attributes_ready doesn't until they change
+  bool failed;
+  Task_counters task_counters; // Of all the tasks
+  List tags; // Interned strings (compare them by pointer)
   List reminders;
   List tasks;
 } Attributes;
 
+// Arena with the ToDos loaded from a file. It's freed when the last of its
+// ToDos is freed
+typedef struct {
+  Arena arena;
+  unsigned int todos; // ToDos allocated in the arena that are still alive
+} Todo_arena;
+
+// Strings of a ToDo that live in its arena
+#define TODO_FIELD_NAME  (1 << 0)
+#define TODO_FIELD_NOTES (1 << 1)
+
 typedef struct {
   char *name; // Primary key
 
-  char *hostname;
+  const char *hostname; // Interned (see intern.h), never freed with the ToDo
   uint64_t creation_time;
   char *notes;
 
   // Runtime-detected attributes from the notes to improve performance
   Attributes attributes;
+
+  // The ToDo is shared with the snapshot of the active transaction, with
+  // the background save or with the thread that builds the attributes, so it
+  // must be cloned before modifying it (see todo_list_get_for_write)
+  bool in_snapshot;
+  bool in_save;
+  bool attributes_pending;
+
+  // NULL if the ToDo was allocated with malloc. The strings are replaced with
+  // todo_set_name/todo_set_notes, so the modified ones are heap allocated
+  Todo_arena *arena;
+  unsigned char arena_fields; // TODO_FIELD_* flags
+
+  // The ToDo is counted in the stats of this generation (see stats.h)
+  unsigned int stats_generation;
+  bool stats_pending;
+
+  unsigned int search_id; // Id in the search index (see search.h)
 } Todo;
 
 Todo *create_todo(char *name);
 bool todo_exists(const char *name);
 bool search_todo_pos_by_name_or_pos(const char *name_or_position, unsigned int *index); // `position` should be 1-based. `index` is 0-based
 void free_todo(Todo *node);
+Todo *clone_todo(const Todo *todo);
+// They take the ownership of the (heap allocated) string
+void todo_set_name(Todo *todo, char *name);
+void todo_set_notes(Todo *todo, char *notes);
+void release_todo(Todo *todo); // Frees the ToDo unless the active transaction or the background save still reference it
 bool is_a_valid_todo_name(char *name);
 
+// Index of the names used by todo_exists. Call todo_names_add after appending
+// or inserting a ToDo, and todo_names_invalidate after any other change of the
+// list (removing ToDos, renaming them or replacing the list)
+void todo_names_add(const Todo *todo);
+void todo_names_invalidate();
+void free_todo_names();
+
+// Fuzzy index (see fuzzy.h) of the names of todo_list, where the index of a
+// match is the 0-based position of the ToDo. The list must not change while
+// the index is in use
+void todo_list_fuzzy_index_init(Fuzzy_index *index);
+void todo_list_fuzzy_index_free(Fuzzy_index *index);
+
 // Import/ Export file
 bool save_todo_to_file(FILE *file, Todo *todo);
-bool load_todo_from_file(const char *load_file_path, FILE *load_file, bool *reached_eof);
+bool load_todos_from_file(const char *load_file_path, FILE *load_file);
 bool write_notes_to_file(FILE *save_file, Todo *todo);
 
 bool create_dir_if_not_exists(char *dir_path);
 bool create_dir_structure();
 
 bool load_todo_list(List *list, char *file_path, bool obligatory);
+// Loads todo_list from the file again, keeping the ToDos that didn't change
+// (with their attributes). Before releasing the ones that changed or were
+// removed, it calls `replaced` (optional) with the ToDo that has the same name
+// in the new list, or NULL
+bool reload_todo_list(char *file_path, void (*replaced)(Todo *old, Todo *new));
 bool save_todo_list(List list, char *file_path);
+bool save_todo_list_to_file(List list, FILE *save_file);
+
+// Open/close a ToDo list file, treating STDIO_FILEPATH as stdin/stdout
+FILE *open_todo_list_file(const char *file_path, const char *mode);
+void close_todo_list_file(FILE *file);
+
+// Transactions: while a transaction is active every change to todo_list can
+// be reverted. Starting one only copies the list nodes; the ToDos are shared
+// with the snapshot and cloned the first time they are modified.
+bool todo_list_transaction_begin();
+bool todo_list_transaction_commit();
+bool todo_list_transaction_rollback();
+bool todo_list_in_transaction();
+Todo *todo_list_get_for_write(unsigned int index);
+// Called (if set) when todo_list_get_for_write replaces a shared ToDo with
+// its copy, so the references to the original can follow it. The original is
+// freed once the transaction or the background work that shares it ends
+extern void (*todo_list_copied)(Todo *original, Todo *copy);
+// Called (if set) by release_todo before releasing a ToDo removed from the
+// list, so the references to it can be dropped
+extern void (*todo_list_released)(Todo *todo);
+
+// Background save: a thread writes a copy of the list nodes to the file, so
+// the caller doesn't wait for it. The ToDos are shared with it like with a
+// transaction. Starting it clears todo_list_modified, and it's set again if
+// the save fails (the errors are appended to the backtrace when it's
+// collected). A save requested while another one is running starts when it
+// ends, with the list at that time
+bool todo_list_save_start(char *file_path);
+// Collects the save if it has finished. Returns if one is still running
+bool todo_list_save_in_progress();
+void todo_list_save_wait();
+
+// Background attributes: a thread builds the attributes of the ToDos of
+// todo_list that have notes, so they don't delay showing the list. The ToDos
+// are shared with it until the main thread collects them, and their errors
+// are discarded (the commands that need the attributes build them again)
+bool todo_list_attributes_start();
+// Collects the ToDos that were built. Returns if it's still running
+bool todo_list_attributes_in_progress();
+void todo_list_attributes_wait();
+void todo_list_attributes_cancel(); // The ToDos that weren't built are left as they were
+// Builds the attributes of the ToDo if they aren't, unless they are being
+// built in the background or its notes failed to parse (attributes.failed).
+// Returns if they can be read
+bool todo_attributes_ready(Todo *todo);
 
 void initialize_notes(Todo *todo);
 
@@ -1,6 +1,8 @@
 #include "backtrace.h"
 #include <stdlib.h>
 
+_Thread_local List *current_backtrace = &backtrace;
+
 void free_backtrace_item(Backtrace_item *b) {
   free(b->message);
   free(b);
@@ -20,6 +20,9 @@ typedef struct {
 } Backtrace_item;
 
 extern List backtrace;
+// Where APPEND_TO_BACKTRACE appends in the calling thread: `backtrace` unless
+// the thread collects its errors apart (see build_attributes_of_todo_list)
+extern _Thread_local List *current_backtrace;
 
 void free_backtrace_item(Backtrace_item *b);
 // print_backtrace is implemented in each interface
@@ -31,7 +34,7 @@ void free_backtrace_item(Backtrace_item *b);
   b->function_name = __func__;                         \
   b->line = __LINE__;                                  \
   b->file = __FILE__;                                  \
-  list_append(&backtrace, b);                          \
+  list_append(current_backtrace, b);                   \
 } while (0)
 
 #endif // BACKTRACE_H
@@ -92,19 +92,18 @@ bool load_config() {
       .length = sb.length,
       .cursor = 0,
     };
-    char *command = next_token(&line, ' ');
-
-    if (!command) {
+    Token_view token;
+    if (!next_token_view(&line, ' ', &token)) {
       sb_clean(&sb);
-      free(command);
       continue;
     }
+    char command[CONFIG_COMMAND_SIZE];
+    token_view_unescape(token, ' ', command, sizeof(command));
 
     bool (*function)(Input *) = search_functionality_function(command, config_functionality, config_functionality_count);
 
     if (!function) {
       APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "%s:%d: Unrecognized command '%s'", idea_state.config_filepath, line_nr, command);
-      free(command);
       sb_free(&sb);
       fclose(config);
       return false;
@@ -112,13 +111,11 @@ bool load_config() {
 
     if (!function(&line)) {
       APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "%s:%d: An error occurred while executing the command '%s'", idea_state.config_filepath, line_nr, command);
-      free(command);
       sb_free(&sb);
       fclose(config);
       return false;
     }
 
-    free(command);
     sb_clean(&sb);
   }
 
@@ -6,6 +6,7 @@
 
 #define CONFIG_PATH ".config"
 #define CONFIG_FILENAME "idea.conf"
+#define CONFIG_COMMAND_SIZE 64
 
 typedef struct {
   char *hostname;
@@ -7,40 +7,53 @@
 #include "../../utils/tokenizer.h"
 #include "backtrace.h"
 
-Date date_now() {
-  time_t now       = time(NULL);
-  struct tm *now_t = localtime(&now);
+// The date only changes once per second at most, and localtime takes a
+// global lock, so each thread keeps the last one
+_Thread_local struct {
+  time_t time;
+  Date date;
+} date_now_cache = {0};
 
-  return (Date) {
-    .year  = now_t->tm_year + 1900,
-    .month = now_t->tm_mon + 1,
-    .day   = now_t->tm_mday,
-  };
-}
+Date date_now() {
+  time_t now = time(NULL);
+  if (now == date_now_cache.time) return date_now_cache.date;
 
-int get_delta_time_days(Date date_from, Date date_to) {
-  // Source: <https://stackoverflow.com/a/73846054>
-  struct tm date_from_tm = {
-    .tm_year = date_from.year - 1900,
-    .tm_mon = date_from.month - 1,
-    .tm_mday = date_from.day,
-    .tm_isdst = -1,
-  };
+  struct tm now_t;
+  localtime_r(&now, &now_t);
 
-  struct tm date_to_tm = {
-    .tm_year = date_to.year - 1900,
-    .tm_mon = date_to.month - 1,
-    .tm_mday = date_to.day,
-    .tm_isdst = -1,
+  date_now_cache.time = now;
+  date_now_cache.date = (Date) {
+    .year  = now_t.tm_year + 1900,
+    .month = now_t.tm_mon + 1,
+    .day   = now_t.tm_mday,
   };
+  return date_now_cache.date;
+}
 
-  time_t date_from_t = mktime(&date_from_tm);
-  time_t date_to_t = mktime(&date_to_tm);
-
-  double dt = difftime(date_to_t, date_from_t);
-  int days = dt / 86400;
+// Days since 1970/01/01 of a date of the proleptic Gregorian calendar. Out of
+// range months and days overflow to the next ones, like with mktime
+long _days_from_civil(Date date) {
+  long year = date.year + (date.month - 1) / 12;
+  int month = (date.month - 1) % 12;
+  if (month < 0) {
+    month += 12;
+    year--;
+  }
+  month++;
+
+  // Source: <https://howardhinnant.github.io/date_algorithms.html#days_from_civil>
+  year -= (month <= 2);
+  const long era = (year >= 0 ? year : year - 399) / 400;
+  const long year_of_era = year - era * 400;
+  const long day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + date.day - 1;
+  const long day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + day_of_era - 719468;
+}
 
-  return days;
+// Computed without mktime, which takes a global lock (the reminders are
+// sorted from several threads) and counts one day less across a DST change
+int get_delta_time_days(Date date_from, Date date_to) {
+  return _days_from_civil(date_to) - _days_from_civil(date_from);
 }
 
 char *get_delta_time_string(Date date_from, Date date_to) {
@@ -92,44 +105,43 @@ bool load_date_from_string(char *date_str, Date *date) {
     .length = strlen(date_str),
     .cursor = 0,
   };
+  Token_view token;
+  char number[16];
 
   // Year
-  char *rem_year_str = next_token(&date_input, '-');
-  if (!rem_year_str) {
+  if (!next_token_view(&date_input, '-', &token)) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to get the year from the date '%s'", date_str);
     return false;
   }
 
-  date->year = atoi(rem_year_str);
-  free(rem_year_str);
+  token_view_unescape(token, '-', number, sizeof(number));
+  date->year = atoi(number);
   if (date->year == 0) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to parse the year from the date '%s'", date_str);
     return false;
   }
 
   // Month
-  char *rem_month_str = next_token(&date_input, '-');
-  if (!rem_month_str) {
+  if (!next_token_view(&date_input, '-', &token)) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to get the month from the date '%s'", date_str);
     return false;
   }
 
-  date->month = atoi(rem_month_str);
-  free(rem_month_str);
+  token_view_unescape(token, '-', number, sizeof(number));
+  date->month = atoi(number);
   if (date->month == 0) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to parse the month from the date '%s'", date_str);
     return false;
   }
 
   // day
-  char *rem_day_str = next_token(&date_input, '-');
-  if (!rem_day_str) {
+  if (!next_token_view(&date_input, '-', &token)) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to get the day from the date '%s'", date_str);
     return false;
   }
 
-  date->day = atoi(rem_day_str);
-  free(rem_day_str);
+  token_view_unescape(token, '-', number, sizeof(number));
+  date->day = atoi(number);
   if (date->day == 0) {
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to parse the day from the date '%s'", date_str);
     return false;
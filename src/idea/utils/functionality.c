@@ -2,6 +2,8 @@
 #include <string.h>
 
 #include "functionality.h"
+#include "backtrace.h"
+#include "../../utils/string.h"
 
 bool (*search_functionality_function(char *instruction, Functionality functionality[], unsigned int functionality_count))(Input *input) {
   if (!instruction) return false;
@@ -15,6 +17,43 @@ bool (*search_functionality_function(char *instruction, Functionality functional
   return (i == functionality_count) ? NULL : functionality[i].function_cmd;
 }
 
+bool _dispatch_table_insert(Dispatch_table *table, const char *cmd, const Functionality *functionality) {
+  const unsigned int mask = DISPATCH_TABLE_CAPACITY-1;
+  unsigned int i = cstr_hash(cmd) & mask;
+  while (table->entries[i].cmd) {
+    if (!strcmp(table->entries[i].cmd, cmd)) return true; // The first one registered has priority
+    i = (i+1) & mask;
+  }
+
+  if ((table->count+1)*2 > DISPATCH_TABLE_CAPACITY) {
+    APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "Unable to register the command '%s': the dispatch table is full (increase DISPATCH_TABLE_CAPACITY)", cmd);
+    return false;
+  }
+
+  table->entries[i] = (Dispatch_entry){ cmd, functionality };
+  table->count++;
+  return true;
+}
+
+bool dispatch_table_register(Dispatch_table *table, Functionality functionality[], unsigned int functionality_count) {
+  for (unsigned int i = 0; i < functionality_count; i++) {
+    const Functionality *f = &functionality[i];
+    if (!_dispatch_table_insert(table, f->full_cmd, f)) return false;
+    if (f->abbreviation_cmd && !_dispatch_table_insert(table, f->abbreviation_cmd, f)) return false;
+  }
+  return true;
+}
+
+const Functionality *dispatch_table_search(const Dispatch_table *table, const char *instruction) {
+  if (!instruction) return NULL;
+
+  const unsigned int mask = DISPATCH_TABLE_CAPACITY-1;
+  for (unsigned int i = cstr_hash(instruction) & mask; table->entries[i].cmd; i = (i+1) & mask) {
+    if (!strcmp(table->entries[i].cmd, instruction)) return table->entries[i].functionality;
+  }
+  return NULL;
+}
+
 bool action_do_nothing(Input *input) {
   input->cursor = input->length+1;
   return true;
@@ -4,7 +4,7 @@
 #include "../../utils/tokenizer.h"
 
 #define ACTION_NO_ARGS(action_name, input) do {                                          \
-  if (has_more_tokens(input, NULL)) {                                                    \
+  if (input && has_more_tokens(input, NULL)) { /* NULL from the TUI mappings */          \
     APPEND_TO_BACKTRACE(BACKTRACE_ERROR, "`" action_name "` doesn't require arguments"); \
     return false;                                                                        \
   }                                                                                      \
@@ -26,6 +26,26 @@ typedef struct {
 } Functionality;
 
 bool (*search_functionality_function(char *instruction, Functionality functionality[], unsigned int functionality_count))(Input *);
+
+// Hash table with the commands (full and abbreviated) of one or more
+// Functionality tables, so every lookup costs a hash and (usually) a single
+// strcmp instead of a strcmp per command of every table.
+#define DISPATCH_TABLE_CAPACITY 256 // Power of 2, at least twice the number of commands
+
+typedef struct {
+  const char *cmd;
+  const Functionality *functionality;
+} Dispatch_entry;
+
+typedef struct {
+  Dispatch_entry entries[DISPATCH_TABLE_CAPACITY]; // Open addressing with linear probing
+  unsigned int count;
+} Dispatch_table;
+
+// The order of registration sets the priority: if a command is already in
+// the table, the one registered first is kept
+bool dispatch_table_register(Dispatch_table *table, Functionality functionality[], unsigned int functionality_count);
+const Functionality *dispatch_table_search(const Dispatch_table *table, const char *instruction);
 bool action_do_nothing(Input *input);
 
 #endif
@@ -62,6 +62,7 @@
 #define CASES() \
   X(import_initial_state) \
   X(execution) \
+  X(expected_output) \
   X(export_final_state) \
   X(expected_final_state) \
   X(clear_after_test)
@@ -75,6 +76,7 @@ typedef struct {
   char *tests_filepath;
   char *initial_states_path;
   char *final_states_path;
+  char *outputs_path;
   char *logs_path;
 
   unsigned int max_test_name_length;
@@ -118,6 +120,7 @@ typedef struct {
 
   bool should_fail_execution;
   bool expect_state_unchanged;
+  bool expect_output;
 
   Test_result results;
 } Test;
@@ -143,6 +146,7 @@ typedef struct {
   // Completed inside the thread:
   char *local_path;
   char *export_filepath;
+  char *output_filepath;
 } Runner_data;
 
 /////// Initialize variables
@@ -156,6 +160,7 @@ Tests_state state = {
   .tests_filepath = NULL,
   .initial_states_path = NULL,
   .final_states_path = NULL,
+  .outputs_path = NULL,
   .logs_path = NULL,
 
   .max_test_name_length = 0,
@@ -333,6 +338,25 @@ bool get_tests(List *tests, List *specific_tests) {
 
       test->expect_state_unchanged = true;
 
+    } else if (!strcmp(tag, "expected_output")) {
+      free(tag);
+
+      if (!test) {
+        printf("%s:%d: [ERROR] Name of the test is not provided!\n", state.tests_filepath, line_nr);
+        ret = false;
+        goto exit;
+      }
+
+      char *params = next_token(&input_line, 0);
+      if (params) {
+        free(params);
+        printf("%s:%d: [ERROR] expected_output is a property, you shouldn't pass any parameters to it!\n", state.tests_filepath, line_nr);
+        ret = false;
+        goto exit;
+      }
+
+      test->expect_output = true;
+
     } else if (!strcmp(tag, "command:")) {
       free(tag);
 
@@ -491,7 +515,10 @@ char *run_test_generate_base_command(Runner_data runner_data, bool valgrind) {
   return base_cmd.str;
 }
 
-bool run_test_execute(Runner_data *runner_data, Test *test, String_builder *cmd, int *ret) {
+// The output of the command is written to `output_path` if it's not NULL
+bool run_test_execute(Runner_data *runner_data, Test *test, String_builder *cmd, const char *output_path, int *ret) {
+  if (output_path) sb_append_with_format(cmd, " > \"%s\"", output_path);
+
   if (state.log) {
     String_builder log_path = sb_create("%s/%s.txt", state.logs_path, test->name);
     FILE *log = fopen(log_path.str, "a");
@@ -503,10 +530,11 @@ bool run_test_execute(Runner_data *runner_data, Test *test, String_builder *cmd,
     fprintf(log, "-----> Running: %s\n", cmd->str);
     fclose(log);
 
-    sb_append_with_format(cmd, " >> \"%s\" 2>&1", log_path.str);
+    if (output_path) sb_append_with_format(cmd, " 2>> \"%s\"", log_path.str);
+    else sb_append_with_format(cmd, " >> \"%s\" 2>&1", log_path.str);
     sb_free(&log_path);
   } else {
-    sb_append(cmd, " > /dev/null 2>&1");
+    sb_append(cmd, (output_path) ? " 2> /dev/null" : " > /dev/null 2>&1");
   }
 
   int system_ret = system(cmd->str);
@@ -529,7 +557,7 @@ bool run_test_execute(Runner_data *runner_data, Test *test, String_builder *cmd,
 bool run_test_case_import_initial_state(Runner_data *runner_data, Test *t, char *base_cmd, bool valgrind) {
   String_builder cmd = sb_create("%s import %s/%s.idea", base_cmd, state.initial_states_path, t->state);
   int cmd_ret;
-  bool ok = run_test_execute(runner_data, t, &cmd, &cmd_ret);
+  bool ok = run_test_execute(runner_data, t, &cmd, NULL, &cmd_ret);
   sb_free(&cmd);
   if (!ok) return false;
 
@@ -550,7 +578,8 @@ bool run_test_case_execution(Runner_data *runner_data, Test *t, char *base_cmd,
       return true;
   }
 
-  String_builder cmd = sb_create("%s", base_cmd);
+  // Without colors, so the output can be compared
+  String_builder cmd = (t->expect_output) ? sb_create("IDEA_CLI_DISABLE_COLORS=1 %s", base_cmd) : sb_create("%s", base_cmd);
   List_iterator iterator = list_iterator_create(t->instructions);
   bool multiple_commands = (list_size(t->instructions) > 1);
   if (multiple_commands) sb_append(&cmd, " -m");
@@ -573,7 +602,7 @@ bool run_test_case_execution(Runner_data *runner_data, Test *t, char *base_cmd,
   }
 
   int cmd_ret;
-  bool ok = run_test_execute(runner_data, t, &cmd, &cmd_ret);
+  bool ok = run_test_execute(runner_data, t, &cmd, (t->expect_output) ? runner_data->output_filepath : NULL, &cmd_ret);
   sb_free(&cmd);
   if (!ok) return false;
 
@@ -592,11 +621,68 @@ bool run_test_case_execution(Runner_data *runner_data, Test *t, char *base_cmd,
   return true;
 }
 
+bool run_test_case_expected_output(Runner_data *runner_data, Test *t, char *base_cmd, bool valgrind) {
+  (void) base_cmd;
+
+  if (valgrind) return true;
+
+  if (!t->expect_output) {
+    t->results.expected_output.result = RESULT_NOT_SPECIFIED;
+    return true;
+  }
+
+  FILE *output_file = fopen(runner_data->output_filepath, "r");
+  if (!output_file) {
+    APPEND_WITH_FORMAT_TO_MESSAGES(runner_data, "Test", t->name, "Unable to open the output file (%s)!", runner_data->output_filepath);
+    return false;
+  }
+
+  String_builder exp_output_path = sb_create("%s/%s.txt", state.outputs_path, t->name);
+  FILE *exp_output_file = fopen(exp_output_path.str, "r");
+  if (!exp_output_file) {
+    fclose(output_file);
+    APPEND_WITH_FORMAT_TO_MESSAGES(runner_data, "Test", t->name, "Unable to open the expected output file (%s)!", exp_output_path.str);
+    sb_free(&exp_output_path);
+    return false;
+  }
+  sb_free(&exp_output_path);
+
+  String_builder line_output = sb_new(), line_exp_output = sb_new();
+  bool read_output = sb_read_line(output_file, &line_output),
+       read_exp_output = sb_read_line(exp_output_file, &line_exp_output);
+
+  unsigned int line_nr = 1;
+  while (read_output && read_exp_output) {
+    if (!sb_equals(line_output, line_exp_output)) {
+      APPEND_WITH_FORMAT_TO_MESSAGES(runner_data, "Test", t->name, "Output differs in the line %u:\n\t- Actual:   %s\n\t- Expected: %s", line_nr, line_output.str, line_exp_output.str);
+      break;
+    }
+
+    sb_clean(&line_output);
+    sb_clean(&line_exp_output);
+
+    read_output = sb_read_line(output_file, &line_output);
+    read_exp_output = sb_read_line(exp_output_file, &line_exp_output);
+    line_nr++;
+  }
+
+  fclose(output_file);
+  fclose(exp_output_file);
+
+  sb_free(&line_output);
+  sb_free(&line_exp_output);
+
+  bool same_output = !(read_output || read_exp_output);
+  t->results.expected_output.result = (same_output) ? RESULT_PASSED : RESULT_FAILED;
+
+  return true;
+}
+
 bool run_test_case_export_final_state(Runner_data *runner_data, Test *t, char *base_cmd, bool valgrind) {
   String_builder cmd = sb_create("%s export %s", base_cmd, runner_data->export_filepath);
 
   int cmd_ret;
-  bool ok = run_test_execute(runner_data, t, &cmd, &cmd_ret);
+  bool ok = run_test_execute(runner_data, t, &cmd, NULL, &cmd_ret);
   sb_free(&cmd);
   if (!ok) return false;
 
@@ -754,7 +840,7 @@ bool run_test_case_clear_after_test(Runner_data *runner_data, Test *t, char *bas
   String_builder cmd = sb_create("%s clear all", base_cmd);
 
   int cmd_ret;
-  bool ok = run_test_execute(runner_data, t, &cmd, &cmd_ret);
+  bool ok = run_test_execute(runner_data, t, &cmd, NULL, &cmd_ret);
   sb_free(&cmd);
   if (!ok) return false;
 
@@ -812,6 +898,7 @@ exit:
     run_test_case_clear_after_test(runner_data, test, base_cmd, false);
 
   remove(runner_data->export_filepath); // Try to remove it
+  remove(runner_data->output_filepath);
   free(base_cmd);
 }
 
@@ -857,6 +944,7 @@ bool initialize_paths() {
   state.tests_filepath      = sb_create("%s/src/tests/tests", state.repo_path).str;
   state.initial_states_path = sb_create("%s/src/tests/states/initial", state.repo_path).str;
   state.final_states_path   = sb_create("%s/src/tests/states/final", state.repo_path).str;
+  state.outputs_path        = sb_create("%s/src/tests/states/output", state.repo_path).str;
 
   if (state.log && !initialize_and_create_log_dir()) return false;
   return true;
@@ -867,6 +955,7 @@ void free_state() {
   if (state.tests_filepath) free(state.tests_filepath);
   if (state.initial_states_path) free(state.initial_states_path);
   if (state.final_states_path) free(state.final_states_path);
+  if (state.outputs_path) free(state.outputs_path);
   if (state.logs_path) free(state.logs_path);
 }
 
@@ -948,6 +1037,7 @@ void *test_runner(void *t_data) {
   data->local_path = sb_create("%s/%ld-idea", state.tmp_path, pthread_self()).str;
   if (!create_dir_if_not_exists(data->local_path)) abort();
   data->export_filepath = sb_create("%s/%ld-export", state.tmp_path, pthread_self()).str;
+  data->output_filepath = sb_create("%s/%ld-output", state.tmp_path, pthread_self()).str;
 
   for (unsigned int i=data->tests_range.start; i<=data->tests_range.end; i++) {
     Test *test = list_get(data->tests, i);
@@ -983,6 +1073,7 @@ void *test_runner(void *t_data) {
 
   free(data->local_path);
   free(data->export_filepath);
+  free(data->output_filepath);
   return NULL;
 }
 
@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdbool.h>
+
+#include "arena.h"
+
+#define ARENA_ALIGNMENT alignof(max_align_t)
+#define align_up(n) (((n) + ARENA_ALIGNMENT-1) & ~(ARENA_ALIGNMENT-1))
+
+void *arena_alloc(Arena *arena, size_t size) {
+  if (!arena) abort();
+  size = align_up(size);
+
+  Arena_block *block = arena->head;
+  if (!block || block->used + size > block->size) {
+    const size_t block_size = (size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE;
+    block = malloc(sizeof(Arena_block) + block_size);
+    if (!block) abort();
+
+    block->size = block_size;
+    block->used = 0;
+    block->next = arena->head;
+    arena->head = block;
+  }
+
+  void *ptr = block->data + block->used;
+  block->used += size;
+  return ptr;
+}
+
+void *arena_realloc(Arena *arena, void *ptr, size_t old_size, size_t new_size) {
+  if (!ptr) return arena_alloc(arena, new_size);
+  if (new_size <= old_size) return ptr;
+
+  Arena_block *block = arena->head;
+  const size_t old_aligned = align_up(old_size);
+  const bool is_last = (block && (char *) ptr + old_aligned == block->data + block->used);
+  if (is_last && block->used - old_aligned + align_up(new_size) <= block->size) {
+    block->used += align_up(new_size) - old_aligned;
+    return ptr;
+  }
+
+  void *new_ptr = arena_alloc(arena, new_size);
+  memcpy(new_ptr, ptr, old_size);
+  return new_ptr;
+}
+
+void arena_free(Arena *arena) {
+  Arena_block *block = arena->head;
+  while (block) {
+    Arena_block *next = block->next;
+    free(block);
+    block = next;
+  }
+  arena->head = NULL;
+}
@@ -0,0 +1,32 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+typedef struct Arena_block {
+  struct Arena_block *next;
+  size_t size;
+  size_t used;
+  char data[];
+} Arena_block;
+
+// Bump allocator: the allocations are never freed one by one, all of them are
+// released at once with arena_free()
+typedef struct {
+  Arena_block *head; // Block where the allocations are being made
+} Arena;
+
+#define arena_new() (Arena) {0}
+
+// The memory is aligned for any type
+void *arena_alloc(Arena *arena, size_t size);
+
+// If `ptr` is the last allocation of the arena it grows in place, otherwise
+// it's copied to a new allocation (the old one is not reused)
+void *arena_realloc(Arena *arena, void *ptr, size_t old_size, size_t new_size);
+
+void arena_free(Arena *arena);
+
+#endif // ARENA_H
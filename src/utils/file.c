@@ -0,0 +1,168 @@
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif // __linux__
+
+#include "file.h"
+
+bool _file_write_fd(int fd, const char *data, size_t length) {
+  while (length > 0) {
+    ssize_t written = write(fd, data, length);
+    if (written == -1) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += written;
+    length -= written;
+  }
+  return true;
+}
+
+bool _file_copy_blocks(int origin, int clone) {
+  char *buffer = malloc(FILE_BLOCK_SIZE);
+  if (!buffer) return false;
+
+  bool ok = true;
+  ssize_t n;
+  while ( (n = read(origin, buffer, FILE_BLOCK_SIZE)) != 0 ) {
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      ok = false;
+      break;
+    }
+
+    if (!_file_write_fd(clone, buffer, n)) {
+      ok = false;
+      break;
+    }
+  }
+
+  free(buffer);
+  return ok;
+}
+
+#ifdef __linux__
+// Returns false if the kernel couldn't copy anything, so the copy can be
+// retried with read/write. `failed` is set if the copy broke in the middle
+bool _file_copy_in_kernel(int origin, int clone, size_t size, bool *failed) {
+  bool use_sendfile = false;
+  size_t left = size;
+
+  while (left > 0) {
+    ssize_t n = (use_sendfile)
+                ? sendfile(clone, origin, NULL, left)
+                : copy_file_range(origin, NULL, clone, NULL, left, 0);
+
+    if (n == -1) {
+      if (errno == EINTR) continue;
+
+      const bool nothing_copied = (left == size);
+      if (nothing_copied && !use_sendfile) { // For example, between file systems in old kernels
+        use_sendfile = true;
+        continue;
+      }
+      if (nothing_copied) return false;
+
+      *failed = true;
+      return true;
+    }
+
+    if (n == 0) break; // The file shrank while copying it
+    left -= n;
+  }
+
+  return true;
+}
+#endif // __linux__
+
+bool file_copy(const char *origin_path, const char *clone_path) {
+  int origin = open(origin_path, O_RDONLY);
+  if (origin == -1) return false;
+
+  struct stat st;
+  if (fstat(origin, &st) == -1) {
+    close(origin);
+    return false;
+  }
+
+  int clone = open(clone_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (clone == -1) {
+    close(origin);
+    return false;
+  }
+
+  bool failed = false;
+  bool copied = false;
+#ifdef __linux__
+  if (S_ISREG(st.st_mode)) copied = _file_copy_in_kernel(origin, clone, st.st_size, &failed);
+#endif // __linux__
+  if (!copied) failed = !_file_copy_blocks(origin, clone);
+
+  close(origin);
+  if (close(clone) == -1) failed = true;
+  return !failed;
+}
+
+bool file_write_all(const char *path, const char *data, size_t length, bool exclusive) {
+  int flags = O_WRONLY | O_CREAT | ((exclusive) ? O_EXCL : O_TRUNC);
+  int fd = open(path, flags, 0644);
+  if (fd == -1) return false;
+
+  bool ok = _file_write_fd(fd, data, length);
+  if (close(fd) == -1) ok = false;
+  return ok;
+}
+
+char *file_read_all(const char *path, size_t *length) {
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) return NULL;
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    return NULL;
+  }
+
+  // The size is only a hint (the file may change while reading it)
+  size_t capacity = (S_ISREG(st.st_mode) && st.st_size > 0) ? st.st_size + 1 : FILE_BLOCK_SIZE;
+  size_t size = 0;
+  char *content = malloc(capacity);
+  if (!content) {
+    close(fd);
+    return NULL;
+  }
+
+  while (true) {
+    if (size == capacity - 1) {
+      capacity *= 2;
+      char *aux = realloc(content, capacity);
+      if (!aux) {
+        free(content);
+        close(fd);
+        return NULL;
+      }
+      content = aux;
+    }
+
+    ssize_t n = read(fd, content + size, capacity - 1 - size);
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      free(content);
+      close(fd);
+      return NULL;
+    }
+    if (n == 0) break;
+    size += n;
+  }
+
+  close(fd);
+  content[size] = '\0';
+  if (length) *length = size;
+  return content;
+}
@@ -0,0 +1,21 @@
+#ifndef FILE_H
+#define FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FILE_BLOCK_SIZE (128 * 1024)
+
+// Copies the file inside the kernel when possible (copy_file_range, then
+// sendfile) and falls back to read/write with big blocks
+bool file_copy(const char *origin_path, const char *clone_path);
+
+// Creates (or truncates) the file and writes all the data to it. If
+// `exclusive` is true, it fails if the file already exists
+bool file_write_all(const char *path, const char *data, size_t length, bool exclusive);
+
+// Returns a null terminated buffer with all the content of the file (NULL on
+// error). The length is stored in `length` if it's not NULL
+char *file_read_all(const char *path, size_t *length);
+
+#endif // FILE_H
@@ -0,0 +1,300 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzzy.h"
+
+#define FUZZY_NO_SCORE (-1000000) // Far below any reachable score, but it can't overflow
+
+char _fuzzy_lower(char c) {
+  return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+// Bit of a (lowercase) character in the masks: one per letter and digit, and
+// the rest of them share the remaining bits
+uint64_t _fuzzy_char_bit(unsigned char c) {
+  if (c >= 'a' && c <= 'z') return 1ULL << (c - 'a');
+  if (c >= '0' && c <= '9') return 1ULL << (26 + c - '0');
+  return 1ULL << (36 + c % 28);
+}
+
+uint64_t _fuzzy_mask(const char *lowercase, unsigned int length) {
+  uint64_t mask = 0;
+  for (unsigned int i = 0; i < length; i++) mask |= _fuzzy_char_bit(lowercase[i]);
+  return mask;
+}
+
+typedef enum {
+  FUZZY_CLASS_SEPARATOR,
+  FUZZY_CLASS_LOWER, // Non ASCII bytes are considered lowercase letters
+  FUZZY_CLASS_UPPER,
+  FUZZY_CLASS_DIGIT,
+} Fuzzy_class;
+
+Fuzzy_class _fuzzy_class(char c) {
+  if (c >= 'a' && c <= 'z') return FUZZY_CLASS_LOWER;
+  if (c >= 'A' && c <= 'Z') return FUZZY_CLASS_UPPER;
+  if (c >= '0' && c <= '9') return FUZZY_CLASS_DIGIT;
+  if ((unsigned char) c >= 128) return FUZZY_CLASS_LOWER;
+  return FUZZY_CLASS_SEPARATOR;
+}
+
+// Bonus of matching a character of class `current` preceded by one of class
+// `previous` (the start of the name counts as a separator)
+unsigned char _fuzzy_bonus(Fuzzy_class previous, Fuzzy_class current) {
+  if (current == FUZZY_CLASS_SEPARATOR) return 0;
+  if (previous == FUZZY_CLASS_SEPARATOR) return FUZZY_BONUS_BOUNDARY;
+  if (previous == FUZZY_CLASS_LOWER && current == FUZZY_CLASS_UPPER) return FUZZY_BONUS_CAMEL_CASE;
+  if (previous != FUZZY_CLASS_DIGIT && current == FUZZY_CLASS_DIGIT) return FUZZY_BONUS_CAMEL_CASE;
+  return 0;
+}
+
+void fuzzy_index_init(Fuzzy_index *index, const char **names, unsigned int count) {
+  *index = (Fuzzy_index) {
+    .names = names,
+    .count = count,
+    .offsets = malloc((count + 1) * sizeof(unsigned int)),
+    .lengths = malloc((count + 1) * sizeof(unsigned int)),
+    .masks = malloc((count + 1) * sizeof(uint64_t)),
+    .candidates = malloc((count + 1) * sizeof(unsigned int)),
+  };
+  if (!index->offsets || !index->lengths || !index->masks || !index->candidates) abort();
+
+  unsigned int total_length = 0, max_length = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    index->offsets[i] = total_length;
+    index->lengths[i] = strlen(names[i]);
+    total_length += index->lengths[i] + 1;
+    if (index->lengths[i] > max_length) max_length = index->lengths[i];
+  }
+
+  index->lowercase = malloc(total_length + 1);
+  index->bonuses = malloc(total_length + 1);
+  index->rows = malloc(4 * (max_length + 1) * sizeof(int));
+  if (!index->lowercase || !index->bonuses || !index->rows) abort();
+
+  for (unsigned int i = 0; i < count; i++) {
+    char *lowercase = &index->lowercase[index->offsets[i]];
+    unsigned char *bonuses = &index->bonuses[index->offsets[i]];
+    Fuzzy_class previous = FUZZY_CLASS_SEPARATOR;
+    uint64_t mask = 0;
+
+    for (unsigned int c = 0; c < index->lengths[i]; c++) {
+      const Fuzzy_class class = _fuzzy_class(names[i][c]);
+      lowercase[c] = _fuzzy_lower(names[i][c]);
+      bonuses[c] = _fuzzy_bonus(previous, class);
+      mask |= _fuzzy_char_bit(lowercase[c]);
+      previous = class;
+    }
+    lowercase[index->lengths[i]] = '\0';
+    index->masks[i] = mask;
+  }
+}
+
+void fuzzy_index_free(Fuzzy_index *index) {
+  free(index->lowercase);
+  free(index->bonuses);
+  free(index->offsets);
+  free(index->lengths);
+  free(index->masks);
+  free(index->rows);
+  free(index->last_pattern);
+  free(index->candidates);
+  *index = (Fuzzy_index) {0};
+}
+
+bool _fuzzy_is_subsequence(const char *pattern, unsigned int pattern_length, const char *text, unsigned int text_length) {
+  const char *end = text + text_length;
+  for (unsigned int i = 0; i < pattern_length; i++) {
+    text = memchr(text, pattern[i], end - text);
+    if (!text) return false;
+    text++;
+  }
+  return true;
+}
+
+// Best alignment of the pattern in the name (it must be a subsequence of it).
+// Each pattern character can only be aligned with its occurrences in the
+// name, so every row of the alignment keeps just those: their position and
+// the best score of the pattern up to that character when it's matched
+// there. With a linear gap penalty, the best predecessor after a gap is the
+// one with the highest `score - position * FUZZY_SCORE_GAP_EXTENSION`, so
+// each row is a single merge with the previous one
+int _fuzzy_score(Fuzzy_index *index, unsigned int i, const char *pattern, unsigned int pattern_length) {
+  const char *lowercase = &index->lowercase[index->offsets[i]];
+  const unsigned char *bonuses = &index->bonuses[index->offsets[i]];
+  const unsigned int length = index->lengths[i];
+
+  // The alignment ends at the last occurrence of the last character
+  unsigned int end = length;
+  while (lowercase[end-1] != pattern[pattern_length-1]) end--;
+
+  unsigned int *previous_positions = (unsigned int *) index->rows, *current_positions = previous_positions + length;
+  int *previous_scores = index->rows + 2*length, *current_scores = previous_scores + length;
+  unsigned int previous_count = 0, current_count = 0;
+
+  for (const char *c = lowercase; (c = memchr(c, pattern[0], lowercase + end - c)); c++) {
+    previous_positions[previous_count] = c - lowercase;
+    previous_scores[previous_count++] = FUZZY_SCORE_MATCH + bonuses[c - lowercase] * FUZZY_BONUS_FIRST_CHAR_MULTIPLIER;
+  }
+
+  for (unsigned int p = 1; p < pattern_length; p++) {
+    current_count = 0;
+    unsigned int k = 0; // Next predecessor that hasn't been considered for a gap
+    int best_gap_key = FUZZY_NO_SCORE;
+
+    const char *start = lowercase + previous_positions[0] + 1;
+    for (const char *c = start; (c = memchr(c, pattern[p], lowercase + end - c)); c++) {
+      const unsigned int j = c - lowercase;
+      while (k < previous_count && previous_positions[k] + 2 <= j) {
+        const int key = previous_scores[k] - (int) previous_positions[k] * FUZZY_SCORE_GAP_EXTENSION;
+        if (key > best_gap_key) best_gap_key = key;
+        k++;
+      }
+
+      int best = FUZZY_NO_SCORE;
+      if (best_gap_key > FUZZY_NO_SCORE) best = best_gap_key + FUZZY_SCORE_GAP_START + ((int) j - 2) * FUZZY_SCORE_GAP_EXTENSION;
+      if (k < previous_count && previous_positions[k] + 1 == j && previous_scores[k] + FUZZY_BONUS_CONSECUTIVE > best) {
+        best = previous_scores[k] + FUZZY_BONUS_CONSECUTIVE;
+      }
+      if (best == FUZZY_NO_SCORE) continue;
+
+      current_positions[current_count] = j;
+      current_scores[current_count++] = best + FUZZY_SCORE_MATCH + bonuses[j];
+    }
+
+    unsigned int *swap_positions = previous_positions;
+    previous_positions = current_positions;
+    current_positions = swap_positions;
+    int *swap_scores = previous_scores;
+    previous_scores = current_scores;
+    current_scores = swap_scores;
+    previous_count = current_count;
+  }
+
+  int score = FUZZY_NO_SCORE;
+  for (unsigned int o = 0; o < previous_count; o++) if (previous_scores[o] > score) score = previous_scores[o];
+  return score;
+}
+
+bool _fuzzy_is_better(Fuzzy_match a, Fuzzy_match b) {
+  if (a.score != b.score) return a.score > b.score;
+  if (a.length != b.length) return a.length < b.length;
+  return a.index < b.index;
+}
+
+int _fuzzy_match_comparator(const void *a, const void *b) {
+  return _fuzzy_is_better(*(const Fuzzy_match *)a, *(const Fuzzy_match *)b) ? -1 : 1;
+}
+
+// `heap` keeps the best `k` matches with the worst one at the root
+void _fuzzy_heap_push(Fuzzy_match *heap, unsigned int *size, unsigned int k, Fuzzy_match match) {
+  if (k == 0) return;
+
+  unsigned int i;
+  if (*size < k) {
+    i = (*size)++;
+    while (i > 0 && _fuzzy_is_better(heap[(i-1)/2], match)) {
+      heap[i] = heap[(i-1)/2];
+      i = (i-1)/2;
+    }
+    heap[i] = match;
+    return;
+  }
+
+  if (!_fuzzy_is_better(match, heap[0])) return;
+  i = 0;
+  while (true) {
+    unsigned int worst = 2*i + 1;
+    if (worst >= *size) break;
+    if (worst + 1 < *size && _fuzzy_is_better(heap[worst], heap[worst+1])) worst++;
+    if (!_fuzzy_is_better(match, heap[worst])) break;
+    heap[i] = heap[worst];
+    i = worst;
+  }
+  heap[i] = match;
+}
+
+typedef struct {
+  const char *str;
+  unsigned int length;
+} Fuzzy_term;
+
+// Splits the pattern by the spaces. `terms` must have room for one term per
+// two characters of the pattern (rounded up)
+unsigned int _fuzzy_split_terms(const char *pattern, Fuzzy_term *terms) {
+  unsigned int count = 0;
+  while (*pattern) {
+    while (*pattern == ' ') pattern++;
+    if (!*pattern) break;
+
+    terms[count].str = pattern;
+    while (*pattern && *pattern != ' ') pattern++;
+    terms[count].length = pattern - terms[count].str;
+    count++;
+  }
+  return count;
+}
+
+// The names that match the new terms are a subset of the ones that matched
+// the last ones if each of the last terms is a subsequence of the new term in
+// its position (typing extends the last term or starts a new one)
+bool _fuzzy_can_narrow(const Fuzzy_index *index, const Fuzzy_term *terms, unsigned int terms_count) {
+  if (!index->last_pattern) return false;
+
+  Fuzzy_term *last_terms = malloc((strlen(index->last_pattern)/2 + 1) * sizeof(Fuzzy_term));
+  if (!last_terms) abort();
+  const unsigned int last_terms_count = _fuzzy_split_terms(index->last_pattern, last_terms);
+
+  bool narrow = (last_terms_count <= terms_count);
+  for (unsigned int t = 0; narrow && t < last_terms_count; t++) {
+    narrow = _fuzzy_is_subsequence(last_terms[t].str, last_terms[t].length, terms[t].str, terms[t].length);
+  }
+  free(last_terms);
+  return narrow;
+}
+
+unsigned int fuzzy_search(Fuzzy_index *index, const char *pattern, Fuzzy_match *matches, unsigned int k) {
+  const unsigned int pattern_length = strlen(pattern);
+  char *lowercase_pattern = malloc(pattern_length + 1);
+  Fuzzy_term *terms = malloc((pattern_length/2 + 1) * sizeof(Fuzzy_term));
+  if (!lowercase_pattern || !terms) abort();
+  for (unsigned int c = 0; c <= pattern_length; c++) lowercase_pattern[c] = _fuzzy_lower(pattern[c]);
+
+  const unsigned int terms_count = _fuzzy_split_terms(lowercase_pattern, terms);
+  uint64_t mask = 0;
+  for (unsigned int t = 0; t < terms_count; t++) mask |= _fuzzy_mask(terms[t].str, terms[t].length);
+
+  const bool narrow = _fuzzy_can_narrow(index, terms, terms_count);
+  const unsigned int scanned = (narrow) ? index->candidates_count : index->count;
+
+  unsigned int found = 0, heap_size = 0;
+  for (unsigned int s = 0; s < scanned; s++) {
+    const unsigned int i = (narrow) ? index->candidates[s] : s;
+    if ((index->masks[i] & mask) != mask) continue;
+
+    bool match = true;
+    for (unsigned int t = 0; match && t < terms_count; t++) {
+      match = _fuzzy_is_subsequence(terms[t].str, terms[t].length, &index->lowercase[index->offsets[i]], index->lengths[i]);
+    }
+    if (!match) continue;
+    index->candidates[found++] = i; // found <= s, so it never overwrites a name not scanned yet
+
+    if (terms_count == 0) {
+      if (heap_size < k) matches[heap_size++] = (Fuzzy_match) { .index = i, .score = 0, .length = index->lengths[i] };
+      continue;
+    }
+
+    int score = 0;
+    for (unsigned int t = 0; t < terms_count; t++) score += _fuzzy_score(index, i, terms[t].str, terms[t].length);
+    _fuzzy_heap_push(matches, &heap_size, k, (Fuzzy_match) { .index = i, .score = score, .length = index->lengths[i] });
+  }
+
+  index->candidates_count = found;
+  free(index->last_pattern);
+  index->last_pattern = lowercase_pattern;
+  free(terms);
+
+  if (terms_count) qsort(matches, heap_size, sizeof(Fuzzy_match), _fuzzy_match_comparator);
+  return found;
+}
@@ -0,0 +1,56 @@
+#ifndef FUZZY_H
+#define FUZZY_H
+
+#include <stdint.h>
+
+// Fuzzy matching of a pattern against a set of names, ranked like fzf: the
+// characters of each term of the pattern (separated by spaces) must appear in
+// order (case insensitive, ASCII), and the score rewards consecutive
+// characters and matches at the start of words (after a separator or a lower
+// to upper case change), and penalizes the gaps between them.
+//
+// The index keeps a lowercase copy of the names, the bonus of each character
+// and a mask of the characters each name contains, so most names are
+// discarded without reading them. It also remembers the names that matched
+// the last pattern: when the new one extends it (e.g. typing one more
+// character), only those are scored again.
+
+#define FUZZY_SCORE_MATCH 16
+#define FUZZY_SCORE_GAP_START -3
+#define FUZZY_SCORE_GAP_EXTENSION -1
+#define FUZZY_BONUS_BOUNDARY 8 // At the start of the name or after a separator
+#define FUZZY_BONUS_CAMEL_CASE 7 // Lower to upper case or letter to digit
+#define FUZZY_BONUS_CONSECUTIVE 4
+#define FUZZY_BONUS_FIRST_CHAR_MULTIPLIER 2
+
+typedef struct {
+  unsigned int index; // Of the name in the array given to fuzzy_index_init
+  int score;
+  unsigned int length; // Of the name. Shorter names win the ties
+} Fuzzy_match;
+
+typedef struct {
+  const char **names; // Not owned, they must outlive the index
+  unsigned int count;
+  char *lowercase; // The names lowercased, one after another
+  unsigned char *bonuses; // Bonus of matching each character of `lowercase`
+  unsigned int *offsets; // Of each name in `lowercase`
+  unsigned int *lengths;
+  uint64_t *masks;
+  int *rows; // Scratch space of the scoring: positions and scores of 2 rows
+
+  // Names that matched `last_pattern`, in order
+  char *last_pattern;
+  unsigned int *candidates;
+  unsigned int candidates_count;
+} Fuzzy_index;
+
+void fuzzy_index_init(Fuzzy_index *index, const char **names, unsigned int count);
+void fuzzy_index_free(Fuzzy_index *index);
+
+// Writes the best min(k, returned value) matches in `matches`, from the best
+// to the worst. Returns the number of names that match. An empty pattern
+// matches all the names in order
+unsigned int fuzzy_search(Fuzzy_index *index, const char *pattern, Fuzzy_match *matches, unsigned int k);
+
+#endif // FUZZY_H
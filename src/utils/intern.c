@@ -0,0 +1,119 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "intern.h"
+#include "string.h"
+
+#define INTERN_MINIMUM_CAPACITY 64
+#define INTERN_STACK_BUFFER_SIZE 256
+
+typedef struct {
+  const char *str; // NULL if the slot is empty
+  unsigned int length;
+  unsigned int hash;
+} Interned_string;
+
+// Open addressing hash set. The strings are allocated in the arena, so they
+// are never moved when the table grows. The lock makes interning safe from
+// several threads (e.g. while building the attributes in parallel)
+struct {
+  Interned_string *table;
+  unsigned int capacity; // Power of 2
+  unsigned int count;
+  Arena strings;
+  pthread_mutex_t lock;
+} interned = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+Interned_string *_interned_find(const char *str, unsigned int length, unsigned int hash) {
+  if (!interned.table) return NULL;
+
+  const unsigned int mask = interned.capacity-1;
+  unsigned int i = hash & mask;
+  while (interned.table[i].str) {
+    const Interned_string *entry = &interned.table[i];
+    if (entry->hash == hash && entry->length == length && !memcmp(entry->str, str, length)) return &interned.table[i];
+    i = (i+1) & mask;
+  }
+  return &interned.table[i];
+}
+
+void _interned_grow() {
+  Interned_string *old_table = interned.table;
+  const unsigned int old_capacity = interned.capacity;
+
+  interned.capacity = (old_capacity) ? old_capacity*2 : INTERN_MINIMUM_CAPACITY;
+  interned.table = calloc(interned.capacity, sizeof(Interned_string));
+  if (!interned.table) abort();
+
+  const unsigned int mask = interned.capacity-1;
+  for (unsigned int i = 0; i < old_capacity; i++) {
+    if (!old_table[i].str) continue;
+
+    unsigned int j = old_table[i].hash & mask;
+    while (interned.table[j].str) j = (j+1) & mask;
+    interned.table[j] = old_table[i];
+  }
+  free(old_table);
+}
+
+const char *intern_n(const char *str, unsigned int length) {
+  if (!str) return NULL;
+
+  const unsigned int hash = cstr_hash_n(str, length);
+  pthread_mutex_lock(&interned.lock);
+
+  Interned_string *slot = _interned_find(str, length, hash);
+  if (slot && slot->str) {
+    const char *found = slot->str; // The slot is freed if another thread grows the table
+    pthread_mutex_unlock(&interned.lock);
+    return found;
+  }
+
+  if ((interned.count+1)*2 > interned.capacity) {
+    _interned_grow();
+    slot = _interned_find(str, length, hash);
+  }
+
+  char *copy = arena_alloc(&interned.strings, length + 1);
+  memcpy(copy, str, length);
+  copy[length] = '\0';
+
+  *slot = (Interned_string){ .str = copy, .length = length, .hash = hash };
+  interned.count++;
+
+  pthread_mutex_unlock(&interned.lock);
+  return copy;
+}
+
+const char *intern(const char *cstr) {
+  if (!cstr) return NULL;
+  return intern_n(cstr, strlen(cstr));
+}
+
+const char *intern_token_view(Token_view token, char divider) {
+  if (!token.escaped) return intern_n(token.str, token.length);
+
+  // The unescaped value is never longer than the token
+  char stack_buffer[INTERN_STACK_BUFFER_SIZE];
+  char *buffer = (token.length < sizeof(stack_buffer)) ? stack_buffer : malloc(token.length + 1);
+  if (!buffer) abort();
+
+  const unsigned int length = token_view_unescape(token, divider, buffer, token.length + 1);
+  const char *str = intern_n(buffer, length);
+
+  if (buffer != stack_buffer) free(buffer);
+  return str;
+}
+
+unsigned int interned_strings_count() {
+  return interned.count;
+}
+
+void free_interned_strings() {
+  free(interned.table);
+  arena_free(&interned.strings);
+  interned.table = NULL;
+  interned.capacity = interned.count = 0;
+}
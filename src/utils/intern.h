@@ -0,0 +1,20 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stdbool.h>
+
+#include "tokenizer.h"
+
+// Global set of immutable strings. Interning the same contents always returns
+// the same pointer, so two interned strings are equal if and only if the
+// pointers are equal. The strings live until free_interned_strings().
+// Interning is thread safe.
+
+const char *intern(const char *cstr);
+const char *intern_n(const char *str, unsigned int length);
+const char *intern_token_view(Token_view token, char divider);
+
+unsigned int interned_strings_count();
+void free_interned_strings();
+
+#endif // INTERN_H
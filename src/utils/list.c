@@ -2,6 +2,95 @@
 
 #include "list.h"
 
+_Thread_local List_node_pool list_node_pool = {0};
+
+List_node *_list_node_alloc() {
+  list_node_pool.stats.allocations++;
+  if (++list_node_pool.stats.live > list_node_pool.stats.peak) list_node_pool.stats.peak = list_node_pool.stats.live;
+
+  List_node *node = list_node_pool.free_nodes;
+  if (node) {
+    list_node_pool.free_nodes = node->next;
+    list_node_pool.stats.reused++;
+    return node;
+  }
+
+  if (!list_node_pool.slabs || list_node_pool.slab_used == LIST_NODE_SLAB_SIZE) {
+    List_node_slab *slab = malloc(sizeof(List_node_slab));
+    if (!slab) abort();
+    slab->next = list_node_pool.slabs;
+    list_node_pool.slabs = slab;
+    list_node_pool.slab_used = 0;
+    list_node_pool.stats.slabs++;
+  }
+
+  return &list_node_pool.slabs->nodes[list_node_pool.slab_used++];
+}
+
+void _list_node_free(List_node *node) {
+  node->next = list_node_pool.free_nodes;
+  list_node_pool.free_nodes = node;
+  list_node_pool.stats.live--;
+}
+
+List_node_pool_stats list_node_pool_stats() {
+  return list_node_pool.stats;
+}
+
+void list_node_pool_free() {
+  if (list_node_pool.stats.live != 0) return;
+
+  List_node_slab *slab = list_node_pool.slabs;
+  while (slab) {
+    List_node_slab *next = slab->next;
+    free(slab);
+    slab = next;
+  }
+  list_node_pool.slabs = NULL;
+  list_node_pool.free_nodes = NULL;
+  list_node_pool.slab_used = 0;
+}
+
+List_node_pool list_node_pool_detach() {
+  List_node_pool pool = list_node_pool;
+  list_node_pool = (List_node_pool) {0};
+  return pool;
+}
+
+void list_node_pool_adopt(List_node_pool pool) {
+  if (!pool.slabs) return;
+
+  // The nodes of the first slab that were never taken are reused as free ones
+  for (unsigned int i = pool.slab_used; i < LIST_NODE_SLAB_SIZE; i++) {
+    pool.slabs->nodes[i].next = pool.free_nodes;
+    pool.free_nodes = &pool.slabs->nodes[i];
+  }
+
+  if (pool.free_nodes) {
+    List_node *last_free = pool.free_nodes;
+    while (last_free->next) last_free = last_free->next;
+    last_free->next = list_node_pool.free_nodes;
+    list_node_pool.free_nodes = pool.free_nodes;
+  }
+
+  // The adopted slabs go after the first one, which may still have nodes
+  List_node_slab *last_slab = pool.slabs;
+  while (last_slab->next) last_slab = last_slab->next;
+  if (list_node_pool.slabs) {
+    last_slab->next = list_node_pool.slabs->next;
+    list_node_pool.slabs->next = pool.slabs;
+  } else {
+    list_node_pool.slabs = pool.slabs;
+    list_node_pool.slab_used = LIST_NODE_SLAB_SIZE;
+  }
+
+  list_node_pool.stats.allocations += pool.stats.allocations;
+  list_node_pool.stats.reused      += pool.stats.reused;
+  list_node_pool.stats.slabs       += pool.stats.slabs;
+  list_node_pool.stats.live        += pool.stats.live;
+  if (list_node_pool.stats.live > list_node_pool.stats.peak) list_node_pool.stats.peak = list_node_pool.stats.live;
+}
+
 void list_append(List *list, void *element) {
   list_insert_at(list, element, list->count);
 }
@@ -33,7 +122,7 @@ void list_insert_at(List *list, void *element, unsigned int pos) {
   if (!list) abort();
   if (!element) abort();
 
-  List_node *node = malloc(sizeof(List_node));
+  List_node *node = _list_node_alloc();
   node->pointer = element;
   node->next = NULL;
 
@@ -75,14 +164,25 @@ bool list_insert_if_unique(List *list, void *element, bool (*comparator_equals)(
 }
 
 void list_filter(List *list, bool (*condition)(void *),  void (*free_element)(void *)) {
-  List_iterator iterator = list_iterator_create(*list);
-  while (list_iterator_next(&iterator)) {
-    void *list_e = list_iterator_element(iterator);
+  // The nodes are unlinked in a single pass
+  List_node *prev = NULL;
+  List_node *node = list->head;
+  while (node) {
+    List_node *next = node->next;
+    void *list_e = node->pointer;
+
+    if (condition(list_e)) {
+      prev = node;
+    } else {
+      if (prev) prev->next = next;
+      else list->head = next;
+      if (list->last == node) list->last = prev;
+      list->count--;
 
-    if (!condition(list_e)) {
-      list_remove_element(list, list_e);
+      _list_node_free(node);
       if (free_element) free_element(list_e);
     }
+    node = next;
   }
 }
 
@@ -133,7 +233,7 @@ void *list_remove(List *list, unsigned int pos) {
 
   list->count--;
   void *remove_data = remove->pointer;
-  free(remove);
+  _list_node_free(remove);
   return remove_data;
 }
 
@@ -163,7 +263,7 @@ void list_destroy(List *list, void (*free_element)(void *)) {
     if (free_element) free_element(aux->pointer);
     List_node *remove = aux;
     aux = aux->next;
-    free(remove);
+    _list_node_free(remove);
   }
 
   list->head = list->last = NULL;
@@ -10,6 +10,42 @@ struct List_node {
 };
 typedef struct List_node List_node;
 
+// The nodes are taken from a per-thread pool: they are allocated in slabs and
+// the removed ones are kept in a free list to be reused
+#define LIST_NODE_SLAB_SIZE 256 // Nodes per slab
+
+typedef struct List_node_slab {
+  struct List_node_slab *next;
+  List_node nodes[LIST_NODE_SLAB_SIZE];
+} List_node_slab;
+
+typedef struct {
+  unsigned long allocations; // Nodes requested
+  unsigned long reused;      // Nodes taken from the free list
+  unsigned long slabs;       // Slabs allocated with malloc
+  long live;                 // Nodes in use (allocated by this thread)
+  long peak;
+} List_node_pool_stats;
+
+typedef struct {
+  List_node *free_nodes; // Linked through `next`
+  List_node_slab *slabs;
+  unsigned int slab_used; // Nodes taken from the first slab
+  List_node_pool_stats stats;
+} List_node_pool;
+
+List_node_pool_stats list_node_pool_stats();
+
+// Frees the slabs of the calling thread. It only does it if all of its nodes
+// were returned (call it after destroying every list)
+void list_node_pool_free();
+
+// A thread whose lists outlive it (e.g. a worker that builds them for another
+// thread) detaches its pool before exiting, and the thread that keeps the
+// lists adopts it: from then on the nodes belong to the adopting thread
+List_node_pool list_node_pool_detach();
+void list_node_pool_adopt(List_node_pool pool);
+
 typedef struct {
   List_node *current;
   List_node *next;
@@ -0,0 +1,146 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pointer_set.h"
+
+#define POINTER_SET_MINIMUM_CAPACITY 16
+
+unsigned int _pointer_set_home(const Pointer_set *set, const void *element) {
+  // Fibonacci hashing, the low bits of the pointers are mostly alignment
+  const uint64_t hash = (uint64_t)(uintptr_t) element * 11400714819323198485ull;
+  return (unsigned int)(hash >> 32) & (set->table_capacity-1);
+}
+
+// Returns the slot of the element, or the empty slot where it would go
+unsigned int _pointer_set_slot(const Pointer_set *set, const void *element) {
+  const unsigned int mask = set->table_capacity-1;
+  unsigned int i = _pointer_set_home(set, element);
+  while (set->table[i] && set->elements[set->table[i]-1] != element) i = (i+1) & mask;
+  return i;
+}
+
+void _pointer_set_rehash(Pointer_set *set) {
+  memset(set->table, 0, set->table_capacity * sizeof(unsigned int));
+  for (unsigned int i = 0; i < set->elements_used; i++) {
+    if (set->elements[i]) set->table[_pointer_set_slot(set, set->elements[i])] = i+1;
+  }
+}
+
+void _pointer_set_compact(Pointer_set *set) {
+  unsigned int used = 0;
+  for (unsigned int i = 0; i < set->elements_used; i++) {
+    if (set->elements[i]) set->elements[used++] = set->elements[i];
+  }
+  set->elements_used = used;
+  _pointer_set_rehash(set);
+}
+
+bool pointer_set_add(Pointer_set *set, const void *element) {
+  if (!set || !element) abort();
+  if (pointer_set_contains(set, element)) return false;
+
+  if (set->elements_used == set->elements_capacity) {
+    if (set->elements_used - set->count > set->count) {
+      _pointer_set_compact(set);
+    } else {
+      set->elements_capacity = (set->elements_capacity) ? set->elements_capacity*2 : POINTER_SET_MINIMUM_CAPACITY;
+      set->elements = realloc(set->elements, set->elements_capacity * sizeof(void *));
+      if (!set->elements) abort();
+    }
+  }
+
+  if ((set->count+1)*2 > set->table_capacity) {
+    set->table_capacity = (set->table_capacity) ? set->table_capacity*2 : POINTER_SET_MINIMUM_CAPACITY;
+    free(set->table);
+    set->table = malloc(set->table_capacity * sizeof(unsigned int));
+    if (!set->table) abort();
+    _pointer_set_rehash(set);
+  }
+
+  set->elements[set->elements_used++] = element;
+  set->table[_pointer_set_slot(set, element)] = set->elements_used;
+  set->count++;
+  return true;
+}
+
+bool pointer_set_remove(Pointer_set *set, const void *element) {
+  if (!set) abort();
+  if (!pointer_set_contains(set, element)) return false;
+
+  const unsigned int mask = set->table_capacity-1;
+  unsigned int hole = _pointer_set_slot(set, element);
+  set->elements[set->table[hole]-1] = NULL;
+  set->count--;
+
+  // Backward shift deletion: move back the entries of the cluster that can't
+  // be found from their home slot once the hole is empty
+  for (unsigned int i = (hole+1) & mask; set->table[i]; i = (i+1) & mask) {
+    const unsigned int home = _pointer_set_home(set, set->elements[set->table[i]-1]);
+    const bool reachable = (hole <= i) ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (reachable) continue;
+
+    set->table[hole] = set->table[i];
+    hole = i;
+  }
+  set->table[hole] = 0;
+  return true;
+}
+
+bool pointer_set_replace(Pointer_set *set, const void *element, const void *replacement) {
+  if (!set || !replacement) abort();
+  if (!pointer_set_contains(set, element) || pointer_set_contains(set, replacement)) return false;
+
+  // Removing it leaves a hole in its position, which the replacement fills
+  const unsigned int position = set->table[_pointer_set_slot(set, element)] - 1;
+  pointer_set_remove(set, element);
+  set->elements[position] = replacement;
+  set->table[_pointer_set_slot(set, replacement)] = position + 1;
+  set->count++;
+  return true;
+}
+
+bool pointer_set_contains(const Pointer_set *set, const void *element) {
+  if (!set) abort();
+  if (!set->count || !element) return false;
+  return set->table[_pointer_set_slot(set, element)] != 0;
+}
+
+unsigned int pointer_set_size(const Pointer_set *set) {
+  return set->count;
+}
+
+bool pointer_set_is_empty(const Pointer_set *set) {
+  return !set->count;
+}
+
+void pointer_set_clear(Pointer_set *set) {
+  if (set->table) memset(set->table, 0, set->table_capacity * sizeof(unsigned int));
+  set->elements_used = set->count = 0;
+}
+
+void pointer_set_free(Pointer_set *set) {
+  free(set->elements);
+  free(set->table);
+  *set = pointer_set_new();
+}
+
+Pointer_set_iterator pointer_set_iterator_create(const Pointer_set *set) {
+  return (Pointer_set_iterator) { .set = set };
+}
+
+bool pointer_set_iterator_next(Pointer_set_iterator *iterator) {
+  if (!iterator) abort();
+
+  const Pointer_set *set = iterator->set;
+  while (iterator->position < set->elements_used) {
+    iterator->element = set->elements[iterator->position++];
+    if (iterator->element) return true;
+  }
+  iterator->element = NULL;
+  return false;
+}
+
+void *pointer_set_iterator_element(Pointer_set_iterator iterator) {
+  return (void *) iterator.element;
+}
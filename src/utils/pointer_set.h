@@ -0,0 +1,52 @@
+#ifndef POINTER_SET_H
+#define POINTER_SET_H
+
+#include <stdbool.h>
+
+// Set of pointers (compared by identity) with O(1) membership that iterates
+// in insertion order.
+//
+// The elements are kept in an array in the order they were added, and an
+// open addressing table maps each pointer to its position in the array.
+// Removing an element leaves a hole in the array, which is compacted when the
+// holes outnumber the elements. Adding elements while iterating is not
+// allowed (it can compact the array), removing them is.
+
+typedef struct {
+  const void **elements; // NULL where an element was removed
+  unsigned int elements_used; // Including the holes
+  unsigned int elements_capacity;
+  unsigned int count;
+
+  unsigned int *table; // Position in `elements` + 1, 0 if the slot is empty
+  unsigned int table_capacity; // Power of 2
+} Pointer_set;
+
+typedef struct {
+  const Pointer_set *set;
+  unsigned int position; // Of the next element to visit
+  const void *element;
+} Pointer_set_iterator;
+
+#define pointer_set_new() (Pointer_set) { 0 }
+
+// Return false if the element was already in the set / wasn't in the set
+bool pointer_set_add(Pointer_set *set, const void *element);
+bool pointer_set_remove(Pointer_set *set, const void *element);
+// Puts the replacement in the place of the element, keeping its order.
+// Returns false if the element isn't in the set or the replacement already is
+bool pointer_set_replace(Pointer_set *set, const void *element, const void *replacement);
+
+bool pointer_set_contains(const Pointer_set *set, const void *element);
+unsigned int pointer_set_size(const Pointer_set *set);
+bool pointer_set_is_empty(const Pointer_set *set);
+
+// Removes all the elements, but keeps the memory to add them again
+void pointer_set_clear(Pointer_set *set);
+void pointer_set_free(Pointer_set *set);
+
+Pointer_set_iterator pointer_set_iterator_create(const Pointer_set *set);
+bool pointer_set_iterator_next(Pointer_set_iterator *iterator);
+void *pointer_set_iterator_element(Pointer_set_iterator iterator);
+
+#endif // POINTER_SET_H
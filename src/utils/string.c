@@ -4,6 +4,8 @@
 
 #include "string.h"
 
+#define SB_MINIMUM_SIZE 32
+
 #define number_length(type, number, length) do { \
   length = (n <= 0) ? 1 : 0;                     \
   type __aux = (n > 0) ? n : -1 * n;             \
@@ -13,53 +15,43 @@
   }                                              \
 } while(0)
 
-#define _sb_append_number(type, format_specifier, number) do { \
-  unsigned int n_length;                                       \
-  number_length(type, number, n_length);                       \
-                                                               \
-  unsigned int new_length = sb->length + n_length;             \
-  _sb_resize_if_necessary(sb, new_length);                     \
-                                                               \
-  sprintf(sb->str + sb->length, format_specifier, n);          \
-  sb->length = new_length;                                     \
-} while (0)
-
-int basic_pow(int base, unsigned int exp) {
-  int result = 1;
-  while (exp) {
-    result *= base;
-    exp--;
-  }
-  return result;
-}
-
 void _sb_resize_if_necessary(String_builder *sb, unsigned int new_length) {
   unsigned int minimum_size = new_length + 1;
   if (minimum_size <= sb->_size) return;
 
-  const int base = 2;
-  const int minimum_exponent = 5;
+  // Next power of 2
+  unsigned int new_size = (minimum_size <= SB_MINIMUM_SIZE) ? SB_MINIMUM_SIZE : 1u << (32 - __builtin_clz(minimum_size - 1));
   bool is_new = (sb->_size == 0);
 
-  if (is_new) sb->_size = basic_pow(base, minimum_exponent-1);
-  unsigned int new_size = sb->_size;
-  while ( (new_size *= base) < minimum_size );
-  sb->str = realloc(sb->str, new_size);
+  if (sb->_arena) sb->str = arena_realloc(sb->_arena, sb->str, sb->_size, new_size);
+  else sb->str = realloc(sb->str, new_size);
   if (!sb->str) abort();
 
   if (is_new) sb->str[0] = '\0';
   sb->_size = new_size;
 }
 
-void _sb_append(String_builder *sb, const char *cstr, unsigned int cstr_length) {
+void _sb_append(String_builder *sb, const char *str, unsigned int length) {
   if (!sb) abort();
-  if (!cstr) abort();
+  if (!str) abort();
 
-  unsigned int new_length = sb->length + cstr_length;
-  _sb_resize_if_necessary(sb, new_length);
+  _sb_resize_if_necessary(sb, sb->length + length);
+  memcpy(sb->str + sb->length, str, length);
+  sb->length += length;
+  sb->str[sb->length] = '\0';
+}
 
-  strcpy(sb->str + sb->length, cstr);
-  sb->length = new_length;
+// Writes the digits backwards in a buffer, so the number is copied just once
+void _sb_append_unsigned(String_builder *sb, unsigned long n, bool negative) {
+  char digits[24];
+  unsigned int i = sizeof(digits);
+  do {
+    digits[--i] = '0' + n % 10;
+    n /= 10;
+  } while (n);
+  if (negative) digits[--i] = '-';
+
+  _sb_append(sb, digits + i, sizeof(digits) - i);
 }
 
 #define pad_unsigned_number(type, number, size) do {  \
@@ -199,6 +191,10 @@ void sb_append(String_builder *sb, const char *cstr) {
   _sb_append(sb, cstr, strlen(cstr));
 }
 
+void sb_append_n(String_builder *sb, const char *str, unsigned int length) {
+  _sb_append(sb, str, length);
+}
+
 void sb_append_str(String_builder *sb_dst, const String_builder sb_src) {
   _sb_append(sb_dst, sb_src.str, sb_src.length);
 }
@@ -209,19 +205,25 @@ void sb_append_c(String_builder *sb, char c) {
 }
 
 void sb_append_int(String_builder *sb, int n) {
-  _sb_append_number(int, "%d", n);
+  _sb_append_unsigned(sb, (n < 0) ? -(unsigned long) n : (unsigned long) n, n < 0);
 }
 
 void sb_append_long(String_builder *sb, long n) {
-  _sb_append_number(long, "%ld", n);
+  _sb_append_unsigned(sb, (n < 0) ? -(unsigned long) n : (unsigned long) n, n < 0);
 }
 
 void sb_append_uint(String_builder *sb, unsigned int n) {
-  _sb_append_number(unsigned int, "%u", n);
+  _sb_append_unsigned(sb, n, false);
 }
 
 void sb_append_char(String_builder *sb, char c) {
-  sb_append(sb, (char[2]){c, '\0'});
+  if (!sb) abort();
+
+  // Like appending a string: '\0' appends nothing
+  _sb_resize_if_necessary(sb, sb->length + 1);
+  if (c == '\0') return;
+  sb->str[sb->length++] = c;
+  sb->str[sb->length] = '\0';
 }
 
 void sb_insert_at(String_builder *sb, unsigned int index, const char *cstr) {
@@ -231,11 +233,9 @@ void sb_insert_at(String_builder *sb, unsigned int index, const char *cstr) {
   unsigned int new_length = sb->length + cstr_length;
   _sb_resize_if_necessary(sb, new_length);
 
-  for (int i = new_length; i >= (int) (index + cstr_length); i--) {
-    sb->str[i] = sb->str[i - cstr_length];
-  }
-
-  strncpy(sb->str+index, cstr, cstr_length);
+  // The null terminator is moved too
+  memmove(sb->str + index + cstr_length, sb->str + index, sb->length - index + 1);
+  memcpy(sb->str + index, cstr, cstr_length);
   sb->length = new_length;
 }
 
@@ -243,12 +243,9 @@ void sb_remove(String_builder *sb, unsigned int index, unsigned int length) {
   if (!sb || index > sb->length) abort();
 
   unsigned int new_length = sb->length - length;
-  _sb_resize_if_necessary(sb, new_length);
 
-  // I can't use strcpy because it overlaps the src and dst (caveat from strcpy)
-  for (unsigned int i=index; i <= new_length; i++) {
-    sb->str[i] = sb->str[i + length];
-  }
+  // The null terminator is moved too
+  memmove(sb->str + index, sb->str + index + length, new_length - index + 1);
   sb->length = new_length;
 }
 
@@ -268,7 +265,7 @@ bool sb_is_empty(String_builder sb) {
 void sb_free(String_builder *sb) {
   sb->length = 0;
   sb->_size = 0;
-  if (sb->str) free(sb->str);
+  if (sb->str && !sb->_arena) free(sb->str);
   sb->str = NULL;
 }
 
@@ -302,22 +299,69 @@ bool sb_read_line(FILE *f, String_builder *sb) {
 }
 
 bool sb_equals(String_builder sb1, String_builder sb2) {
-  return (sb1.length == sb2.length && !strcmp(sb1.str, sb2.str));
+  return (sb1.length == sb2.length && (!sb1.length || !memcmp(sb1.str, sb2.str, sb1.length)));
 }
 
+// Single pass: the result is built in a new buffer (or in place when the
+// replacement isn't longer than the search), so every character is moved once
 bool sb_search_and_replace(String_builder *sb, const char *search, const char *replace) {
   const unsigned int search_length = strlen(search);
   const unsigned int replace_length = strlen(replace);
-  bool found = false;
-
-  for (unsigned int i=0; i<sb->length; i++) {
-    if (cstr_starts_with(sb->str+i, search)) {
-      sb_remove(sb, i, search_length);
-      sb_insert_at(sb, i, replace);
-      found = true;
-      i += replace_length - search_length;
+  if (!search_length || sb->length < search_length) return false;
+
+  const char *first = strstr(sb->str, search);
+  if (!first) return false;
+
+  if (replace_length <= search_length) {
+    char *dst = sb->str + (first - sb->str);
+    const char *src = first;
+    const char *end = sb->str + sb->length;
+    while (src < end) {
+      if ((unsigned int) (end - src) >= search_length && !memcmp(src, search, search_length)) {
+        memcpy(dst, replace, replace_length);
+        dst += replace_length;
+        src += search_length;
+      } else {
+        *dst++ = *src++;
+      }
     }
+    *dst = '\0';
+    sb->length = dst - sb->str;
+    return true;
+  }
+
+  String_builder result = { ._arena = sb->_arena };
+  _sb_resize_if_necessary(&result, sb->length + replace_length - search_length);
+
+  const char *src = sb->str;
+  const char *match = first;
+  while (match) {
+    _sb_append(&result, src, match - src);
+    _sb_append(&result, replace, replace_length);
+    src = match + search_length;
+    match = strstr(src, search);
   }
+  _sb_append(&result, src, sb->str + sb->length - src);
 
-  return found;
+  sb_free(sb);
+  *sb = result;
+  return true;
+}
+
+unsigned int cstr_hash(const char *cstr) {
+  unsigned int hash = 2166136261u;
+  for (; *cstr; cstr++) {
+    hash ^= (unsigned char) *cstr;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+unsigned int cstr_hash_n(const char *cstr, unsigned int length) {
+  unsigned int hash = 2166136261u;
+  for (unsigned int i = 0; i < length; i++) {
+    hash ^= (unsigned char) cstr[i];
+    hash *= 16777619u;
+  }
+  return hash;
 }
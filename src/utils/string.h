@@ -4,14 +4,21 @@
 #include <stdio.h>
 #include <stdbool.h>
 
+#include "arena.h"
+
 typedef struct {
   char *str;
   unsigned int length;
   unsigned int _size;
+  Arena *_arena; // If it's not NULL, the string is allocated in this arena
 } String_builder;
 
 #define sb_new() (String_builder) {0}
 
+// The string lives as long as the arena, so there is no need to free it
+// (sb_free just forgets it)
+#define sb_new_in_arena(arena) (String_builder) { ._arena = (arena) }
+
 #define cstr_starts_with(cstr, start) (!strncmp(start, cstr, strlen(start)))
 
 #define sb_inspect(sb) do {                                     \
@@ -35,6 +42,9 @@ bool sb_append_from_shell_variable(String_builder *sb, const char *variable);
 
 void sb_append(String_builder *sb, const char *cstr);
 
+// Appends `length` bytes of `str` (it doesn't need to be null-terminated)
+void sb_append_n(String_builder *sb, const char *str, unsigned int length);
+
 // Source of attribute: <https://stackoverflow.com/a/78774629>
 void sb_append_with_format(String_builder *sb, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
 
@@ -69,4 +79,8 @@ bool sb_equals(String_builder sb1, String_builder sb2);
 
 bool sb_search_and_replace(String_builder *sb, const char *search, const char *replace);
 
+// FNV-1a hash of a C string
+unsigned int cstr_hash(const char *cstr);
+unsigned int cstr_hash_n(const char *cstr, unsigned int length); // Same hash, of the first `length` chars
+
 #endif // STRINGS_H
@@ -1,37 +1,115 @@
+#include <stdlib.h>
+#include <string.h>
+
 #include "tokenizer.h"
 #include "string.h"
 
-char *next_token(Input *input, char divider) {
-  if (input->cursor > input->length) return NULL;
+bool next_token_view(Input *input, char divider, Token_view *token) {
+  if (input->cursor > input->length) return false;
 
-  String_builder sb = sb_new();
   unsigned int i = input->cursor;
   bool escaped = false;
-  while (i <= input->length) {
+  token->escaped = false;
+  while (i < input->length) {
     const char c = input->input[i];
 
     if (escaped) {
-      if (c == '\\') {
-        sb_append_char(&sb, c);
-      } else if (c == divider) {
-        sb_append_char(&sb, divider);
-      } else {
-        sb_append(&sb, (char[]){ '\\', c, '\0'});
-      }
       escaped = false;
-    } else {
-      if (c == '\\') {
-        escaped = true;
-      } else {
-        if (c == divider) break;
-        sb_append_char(&sb, c);
-      }
+    } else if (c == '\\') {
+      escaped = true;
+      token->escaped = true;
+    } else if (c == divider) {
+      break;
     }
     i++;
   }
 
+  token->str = input->input + input->cursor;
+  token->length = i - input->cursor;
   input->cursor = i + 1;
-  return sb.str;
+
+  // Empty tokens are skipped, except the last one of the input
+  return token->length || (i == input->length && divider != '\0');
+}
+
+// '\\' is a backslash and '\' + divider is the divider. Any other escape
+// sequence (and a backslash at the end of the token) is kept as it is.
+unsigned int token_view_unescape(Token_view token, char divider, char *buffer, unsigned int buffer_size) {
+  unsigned int length = 0;
+
+  for (unsigned int i = 0; i < token.length; i++) {
+    char c = token.str[i];
+    char escaped_c = '\0';
+
+    if (c == '\\' && i+1 < token.length) {
+      const char next = token.str[++i];
+      if (next == '\\' || next == divider) {
+        c = next;
+      } else {
+        escaped_c = next;
+      }
+    }
+
+    if (length+1 < buffer_size) buffer[length] = c;
+    length++;
+    if (escaped_c) {
+      if (length+1 < buffer_size) buffer[length] = escaped_c;
+      length++;
+    }
+  }
+
+  if (buffer_size) buffer[(length < buffer_size) ? length : buffer_size-1] = '\0';
+  return length;
+}
+
+bool token_view_equals(Token_view token, char divider, const char *cstr) {
+  if (!token.escaped) {
+    const unsigned int cstr_length = strlen(cstr);
+    return (token.length == cstr_length && !strncmp(token.str, cstr, cstr_length));
+  }
+
+  // Unescapes it while comparing (same rules as token_view_unescape), so the
+  // length of the token doesn't matter
+  unsigned int j = 0;
+  for (unsigned int i = 0; i < token.length; i++) {
+    char c = token.str[i];
+
+    if (c == '\\' && i+1 < token.length) {
+      const char next = token.str[i+1];
+      if (next == '\\' || next == divider) {
+        c = next;
+        i++;
+      }
+      // Otherwise the backslash is kept, and the next character is compared
+      // in the following iteration
+    }
+
+    if (cstr[j++] != c) return false;
+  }
+  return cstr[j] == '\0';
+}
+
+char *token_view_dup(Token_view token, char divider) {
+  char *str = malloc(token.length + 1);
+  if (!str) abort();
+  token_view_unescape(token, divider, str, token.length + 1);
+  return str;
+}
+
+void sb_append_token_view(String_builder *sb, Token_view token, char divider) {
+  const unsigned int start = sb->length;
+  sb_append_n(sb, token.str, token.length);
+  if (!token.escaped) return;
+
+  // Unescaping can only shrink the token, so do it in place
+  const Token_view copy = { sb->str + start, token.length, true };
+  sb->length = start + token_view_unescape(copy, divider, sb->str + start, token.length + 1);
+}
+
+char *next_token(Input *input, char divider) {
+  Token_view token;
+  if (!next_token_view(input, divider, &token)) return NULL;
+  return token_view_dup(token, divider);
 }
 
 bool has_more_tokens(Input *input, char **left_overs) {
@@ -3,12 +3,34 @@
 
 #include <stdbool.h>
 
+#include "string.h"
+
 typedef struct {
   char *input;
   unsigned int length;
   unsigned int cursor;
 } Input;
 
+// A token that points inside the Input (it's NOT null-terminated). The escape
+// sequences are kept as they are in the input, so use token_view_unescape()
+// (or the other token_view_* functions) to read its value.
+typedef struct {
+  const char *str;
+  unsigned int length; // Length in the input (with the escape sequences)
+  bool escaped;        // It contains escape sequences
+} Token_view;
+
+// Returns false when there are no more tokens (when next_token() would return NULL)
+bool next_token_view(Input *input, char divider, Token_view *token);
+
+// Writes the value of the token (null-terminated) into `buffer`, truncating it
+// if it doesn't fit. Returns the length of the whole value, which is never
+// greater than token.length. `buffer` may point to token.str.
+unsigned int token_view_unescape(Token_view token, char divider, char *buffer, unsigned int buffer_size);
+bool token_view_equals(Token_view token, char divider, const char *cstr);
+char *token_view_dup(Token_view token, char divider);
+void sb_append_token_view(String_builder *sb, Token_view token, char divider);
+
 char *next_token(Input *input, char divider);
 bool has_more_tokens(Input *input, char **left_overs);
 
@@ -0,0 +1,58 @@
+#include <stdlib.h>
+
+#include "trie.h"
+
+bool _trie_is_valid_char(char c) {
+  return (unsigned char) c < TRIE_ALPHABET_SIZE;
+}
+
+bool trie_insert(Trie *trie, const char *key, const void *value) {
+  if (!trie || !key || !value) abort();
+  if (!*key) return false;
+  for (const char *c = key; *c; c++) if (!_trie_is_valid_char(*c)) return false;
+
+  if (!trie->root) {
+    trie->root = calloc(1, sizeof(Trie_node));
+    if (!trie->root) abort();
+  }
+
+  Trie_node *node = trie->root;
+  for (const char *c = key; *c; c++) {
+    Trie_node **child = &node->children[(unsigned char) *c];
+    if (!*child) {
+      *child = calloc(1, sizeof(Trie_node));
+      if (!*child) abort();
+    }
+    node = *child;
+  }
+  node->value = value;
+  return true;
+}
+
+void _trie_node_free(Trie_node *node) {
+  if (!node) return;
+  for (unsigned int i = 0; i < TRIE_ALPHABET_SIZE; i++) _trie_node_free(node->children[i]);
+  free(node);
+}
+
+void trie_free(Trie *trie) {
+  _trie_node_free(trie->root);
+  *trie = trie_new();
+}
+
+const Trie_node *trie_find_prefix(const Trie *trie, const char *key) {
+  if (!trie || !key) abort();
+
+  const Trie_node *node = trie->root;
+  for (const char *c = key; node && *c; c++) node = trie_node_child(node, *c);
+  return node;
+}
+
+const Trie_node *trie_node_child(const Trie_node *node, char c) {
+  if (!node || !_trie_is_valid_char(c)) return NULL;
+  return node->children[(unsigned char) c];
+}
+
+void *trie_node_value(const Trie_node *node) {
+  return (node) ? (void *) node->value : NULL;
+}
@@ -0,0 +1,34 @@
+#ifndef TRIE_H
+#define TRIE_H
+
+#include <stdbool.h>
+
+// Prefix tree of ASCII strings. Each node has a child for every character, so
+// walking a key is O(key length) whatever the number of keys. It's meant for
+// small sets of short keys (e.g. key mappings), as every node takes
+// TRIE_ALPHABET_SIZE pointers.
+
+#define TRIE_ALPHABET_SIZE 128
+
+typedef struct Trie_node {
+  const void *value; // NULL if no key ends in this node
+  struct Trie_node *children[TRIE_ALPHABET_SIZE];
+} Trie_node;
+
+typedef struct {
+  Trie_node *root;
+} Trie;
+
+#define trie_new() (Trie) { 0 }
+
+// Replaces the value if the key was already in the trie. The key must not be
+// empty or contain characters out of the alphabet, and the value can't be NULL
+bool trie_insert(Trie *trie, const char *key, const void *value);
+void trie_free(Trie *trie);
+
+// Node where the key ends, NULL if no key of the trie starts with it
+const Trie_node *trie_find_prefix(const Trie *trie, const char *key);
+const Trie_node *trie_node_child(const Trie_node *node, char c);
+void *trie_node_value(const Trie_node *node);
+
+#endif // TRIE_H